@@ -0,0 +1,116 @@
+/**
+ * \file Benchmark.cpp
+ *
+ * Implementation of the benchmark harness: timing, statistics and
+ * JSON/CSV reporting
+ */
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace serial{
+namespace benchmark{
+
+  //--------------------------------------------------------------------------
+  // Constructor
+  //--------------------------------------------------------------------------
+
+  Runner::Runner( const options& opts )
+    : m_options(opts)
+  {
+
+  }
+
+  //--------------------------------------------------------------------------
+  // Reporting
+  //--------------------------------------------------------------------------
+
+  void Runner::report( std::ostream& out ) const
+  {
+    if(m_options.format == options::format_csv){
+      out << "name,items,samples,min_ns,median_ns,mean_ns,max_ns\n";
+      for(const auto& r : m_results){
+        out << r.name      << ','
+            << r.items     << ','
+            << r.samples   << ','
+            << r.min_ns    << ','
+            << r.median_ns << ','
+            << r.mean_ns   << ','
+            << r.max_ns    << '\n';
+      }
+      return;
+    }
+
+    out << "{\n"
+        << "  \"context\": {\n"
+        << "    \"size\": "        << m_options.size        << ",\n"
+        << "    \"depth\": "       << m_options.depth       << ",\n"
+        << "    \"fanout\": "      << m_options.fanout      << ",\n"
+        << "    \"repetitions\": " << m_options.repetitions << ",\n"
+        << "    \"seed\": "        << m_options.seed        << "\n"
+        << "  },\n"
+        << "  \"benchmarks\": [";
+
+    for(std::size_t i = 0; i < m_results.size(); ++i){
+      const result& r = m_results[i];
+      out << (i ? ",\n" : "\n")
+          << "    {"
+          << "\"name\": \""     << r.name      << "\", "
+          << "\"items\": "      << r.items     << ", "
+          << "\"samples\": "    << r.samples   << ", "
+          << "\"min_ns\": "     << r.min_ns    << ", "
+          << "\"median_ns\": "  << r.median_ns << ", "
+          << "\"mean_ns\": "    << r.mean_ns   << ", "
+          << "\"max_ns\": "     << r.max_ns    << "}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+  //--------------------------------------------------------------------------
+  // Private Member Functions
+  //--------------------------------------------------------------------------
+
+  bool Runner::enabled( const std::string& name ) const
+  {
+    return m_options.filter.empty() ||
+           name.find(m_options.filter) != std::string::npos;
+  }
+
+  void Runner::record( const std::string& name,
+                       std::size_t items,
+                       std::vector<double>& samples )
+  {
+    if(samples.empty()) return;
+
+    const double per_item = static_cast<double>(std::max<std::size_t>(items, 1));
+    for(auto& sample : samples){
+      sample /= per_item;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    result r;
+    r.name      = name;
+    r.items     = items;
+    r.samples   = samples.size();
+    r.min_ns    = samples.front();
+    r.max_ns    = samples.back();
+    r.median_ns = samples[samples.size() / 2];
+    r.mean_ns   = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+    m_results.push_back(r);
+  }
+
+  //--------------------------------------------------------------------------
+  // Sink
+  //--------------------------------------------------------------------------
+
+  static volatile std::size_t g_sink = 0;
+
+  void consume( std::size_t value )
+  {
+    g_sink = g_sink + value;
+  }
+
+} // namespace benchmark
+} // namespace serial
@@ -0,0 +1,176 @@
+/**
+ * \file Benchmark.hpp
+ *
+ * A minimal, self-contained benchmark harness that times user-supplied
+ * operations and reports the results as JSON or CSV
+ *
+ */
+#ifndef SERIAL_BENCHMARK_BENCHMARK_HPP_
+#define SERIAL_BENCHMARK_BENCHMARK_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace serial{
+namespace benchmark{
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Options controlling corpus generation and measurement
+  /////////////////////////////////////////////////////////////////////////////
+  struct options
+  {
+    /// \brief Output formats for the results
+    enum output_format
+    {
+      format_json, ///< a single JSON document
+      format_csv   ///< one CSV row per benchmark
+    };
+
+    std::size_t   size        = 10000;       ///< elements in flat arrays/objects
+    std::size_t   depth       = 4;           ///< nesting depth of generated trees
+    std::size_t   fanout      = 8;           ///< children per level of generated trees
+    std::size_t   repetitions = 15;          ///< timed samples per benchmark
+    std::uint32_t seed        = 42;          ///< seed for the corpus generators
+    std::string   filter;                    ///< run only names containing this
+    output_format format      = format_json; ///< the output format
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Timing summary of a single benchmark
+  /////////////////////////////////////////////////////////////////////////////
+  struct result
+  {
+    std::string name;      ///< the name of the benchmark
+    std::size_t items;     ///< items processed per sample
+    std::size_t samples;   ///< number of timed samples
+    double      min_ns;    ///< fastest sample, in nanoseconds per item
+    double      median_ns; ///< median sample, in nanoseconds per item
+    double      mean_ns;   ///< mean sample, in nanoseconds per item
+    double      max_ns;    ///< slowest sample, in nanoseconds per item
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Runs and records benchmarks
+  ///
+  /// Each sample calls \c setup outside of the timed region, then times a
+  /// single call of the operation on the state that \c setup returned.
+  /////////////////////////////////////////////////////////////////////////////
+  class Runner final{
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs a runner with the given options
+    ///
+    /// \param opts the options to run with
+    explicit Runner( const options& opts );
+
+    //-------------------------------------------------------------------------
+    // Running
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Times \p op on fresh state from \p setup
+    ///
+    /// \param name  the name of the benchmark
+    /// \param items the number of items \p op processes, for per-item times
+    /// \param setup a callable returning the state for one sample
+    /// \param op    a callable taking the state by reference
+    template<typename Setup, typename Op>
+    void run( const std::string& name, std::size_t items, Setup setup, Op op );
+
+    /// \brief Times \p op, which needs no per-sample state
+    ///
+    /// \param name  the name of the benchmark
+    /// \param items the number of items \p op processes, for per-item times
+    /// \param op    a callable taking no arguments
+    template<typename Op>
+    void run( const std::string& name, std::size_t items, Op op );
+
+    //-------------------------------------------------------------------------
+    // Reporting
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Writes all recorded results in the configured format
+    ///
+    /// \param out the stream to write to
+    void report( std::ostream& out ) const;
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    bool enabled( const std::string& name ) const;
+
+    void record( const std::string& name,
+                 std::size_t items,
+                 std::vector<double>& samples );
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    options             m_options; ///< the options to run with
+    std::vector<result> m_results; ///< the recorded results
+  };
+
+  /// \brief Feeds \p value into a sink the optimizer cannot see through, so
+  ///        that benchmarked work is not eliminated
+  ///
+  /// \param value the value to consume
+  void consume( std::size_t value );
+
+  //---------------------------------------------------------------------------
+  // Inline Definitions
+  //---------------------------------------------------------------------------
+
+  template<typename Setup, typename Op>
+  inline void Runner::run( const std::string& name,
+                           std::size_t items,
+                           Setup setup,
+                           Op op )
+  {
+    typedef std::chrono::steady_clock clock;
+
+    if(!enabled(name)) return;
+
+    // Warm the caches and the allocator before timing
+    {
+      auto state = setup();
+      op(state);
+    }
+
+    std::vector<double> samples;
+    samples.reserve(m_options.repetitions);
+
+    for(std::size_t i = 0; i < m_options.repetitions; ++i){
+      auto state = setup();
+
+      const clock::time_point start = clock::now();
+      op(state);
+      const clock::time_point end   = clock::now();
+
+      samples.push_back(std::chrono::duration<double,std::nano>(end - start).count());
+    }
+    record(name, items, samples);
+  }
+
+  template<typename Op>
+  inline void Runner::run( const std::string& name, std::size_t items, Op op )
+  {
+    run(name, items, []{ return 0; }, [&op](int&){ op(); });
+  }
+
+} // namespace benchmark
+} // namespace serial
+
+#endif /* SERIAL_BENCHMARK_BENCHMARK_HPP_ */
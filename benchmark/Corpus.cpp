@@ -0,0 +1,135 @@
+/**
+ * \file Corpus.cpp
+ *
+ * Implementation of the deterministic synthetic document generators
+ */
+#include "Corpus.hpp"
+
+#include <random>
+
+namespace serial{
+namespace benchmark{
+
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  static DataValue make_scalar( std::mt19937& rng )
+  {
+    DataValue result;
+    switch(rng() % 4)
+    {
+    case 0:
+      result.set_int(static_cast<std::int32_t>(rng() % 100000));
+      break;
+    case 1:
+      result.set_double(static_cast<double>(rng() % 100000) / 100.0);
+      break;
+    case 2:
+      result.set_bool((rng() & 1) != 0);
+      break;
+    default:
+      result.set_string("value_" + std::to_string(rng() % 1000));
+      break;
+    }
+    return result;
+  }
+
+  static DataValue make_level( std::mt19937& rng,
+                               std::size_t depth,
+                               std::size_t fanout,
+                               bool object )
+  {
+    if(depth == 0){
+      return make_scalar(rng);
+    }
+
+    DataValue result(object ? DataValue::type_object : DataValue::type_array);
+    for(std::size_t i = 0; i < fanout; ++i){
+      DataValue child = make_level(rng, depth - 1, fanout, !object);
+      if(object){
+        result.add_member(make_key(i), child);
+      }else{
+        result.add_member(child);
+      }
+    }
+    return result;
+  }
+
+  //--------------------------------------------------------------------------
+  // Generators
+  //--------------------------------------------------------------------------
+
+  std::string make_key( std::size_t i )
+  {
+    return "key_" + std::to_string(i);
+  }
+
+  DataValue make_int_array( std::size_t count, std::uint32_t seed )
+  {
+    std::mt19937 rng(seed);
+
+    DataValue result(DataValue::type_array);
+    for(std::size_t i = 0; i < count; ++i){
+      result.add_member(DataValue(static_cast<std::int32_t>(rng() % 100000)));
+    }
+    return result;
+  }
+
+  DataValue make_flat_object( std::size_t count, std::uint32_t seed )
+  {
+    std::mt19937 rng(seed);
+
+    DataValue result(DataValue::type_object);
+    for(std::size_t i = 0; i < count; ++i){
+      result.add_member(make_key(i), make_scalar(rng));
+    }
+    return result;
+  }
+
+  DataValue make_tree( std::size_t depth, std::size_t fanout, std::uint32_t seed )
+  {
+    std::mt19937 rng(seed);
+
+    return make_level(rng, depth, fanout, true);
+  }
+
+  DataValue make_records( std::size_t count, std::uint32_t seed )
+  {
+    std::mt19937 rng(seed);
+
+    DataValue result(DataValue::type_array);
+    for(std::size_t i = 0; i < count; ++i){
+      DataValue record(DataValue::type_object);
+      DataValue name;
+      name.set_string("record_" + std::to_string(rng() % 100000));
+
+      record.add_member("id",     DataValue(static_cast<std::int32_t>(i)));
+      record.add_member("active", DataValue((rng() & 1) != 0));
+      record.add_member("score",  DataValue(static_cast<double>(rng() % 10000) / 100.0));
+      record.add_member("name",   name);
+      record.add_member("x",      DataValue(static_cast<std::int32_t>(rng() % 1000)));
+      record.add_member("y",      DataValue(static_cast<std::int32_t>(rng() % 1000)));
+      record.add_member("z",      DataValue(static_cast<std::int32_t>(rng() % 1000)));
+      result.add_member(record);
+    }
+    return result;
+  }
+
+  std::size_t count_nodes( const DataValue& value )
+  {
+    std::size_t count = 1;
+    if(value.is_array()){
+      value.for_each_array([&](const DataValue& x){
+        count += count_nodes(x);
+      });
+    }else if(value.is_object()){
+      value.for_each_object([&](const std::string&, const DataValue& x){
+        count += count_nodes(x);
+      });
+    }
+    return count;
+  }
+
+} // namespace benchmark
+} // namespace serial
@@ -0,0 +1,69 @@
+/**
+ * \file Corpus.hpp
+ *
+ * Deterministic generators of synthetic \c DataValue documents used by the
+ * benchmarks
+ *
+ */
+#ifndef SERIAL_BENCHMARK_CORPUS_HPP_
+#define SERIAL_BENCHMARK_CORPUS_HPP_
+
+#include <DataValue.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace serial{
+namespace benchmark{
+
+  /// \brief Generates the key used for the \p i'th member of an object
+  ///
+  /// \param i the index of the member
+  /// \return the key
+  std::string make_key( std::size_t i );
+
+  /// \brief Generates an array of \p count pseudo-random integers
+  ///
+  /// \param count the number of elements
+  /// \param seed  the generator seed
+  /// \return the array
+  DataValue make_int_array( std::size_t count, std::uint32_t seed );
+
+  /// \brief Generates an object of \p count members with mixed scalar values
+  ///        (ints, doubles, bools and short strings), keyed by \c make_key
+  ///
+  /// \param count the number of members
+  /// \param seed  the generator seed
+  /// \return the object
+  DataValue make_flat_object( std::size_t count, std::uint32_t seed );
+
+  /// \brief Generates a tree of alternating objects and arrays, \p depth
+  ///        levels deep with \p fanout children per level and mixed scalar
+  ///        leaves
+  ///
+  /// \param depth  the number of container levels
+  /// \param fanout the number of children of each container
+  /// \param seed   the generator seed
+  /// \return the root of the tree
+  DataValue make_tree( std::size_t depth, std::size_t fanout, std::uint32_t seed );
+
+  /// \brief Generates an array of \p count record objects with the members
+  ///        \c id, \c active, \c score, \c name, \c x, \c y and \c z
+  ///
+  /// \param count the number of records
+  /// \param seed  the generator seed
+  /// \return the array of records
+  DataValue make_records( std::size_t count, std::uint32_t seed );
+
+  /// \brief Counts every node in \p value, including \p value itself
+  ///
+  /// \param value the root to count from
+  /// \return the number of nodes
+  std::size_t count_nodes( const DataValue& value );
+
+} // namespace benchmark
+} // namespace serial
+
+#endif /* SERIAL_BENCHMARK_CORPUS_HPP_ */
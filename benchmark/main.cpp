@@ -0,0 +1,625 @@
+/**
+ * \file main.cpp
+ *
+ * Benchmarks for building, querying, comparing, patching and translating
+ * \c DataValue trees over synthetic documents.
+ *
+ * Usage: serial_benchmark [--size=N] [--depth=N] [--fanout=N]
+ *                         [--repetitions=N] [--seed=N] [--filter=TEXT]
+ *                         [--format=json|csv]
+ *
+ */
+#include "Benchmark.hpp"
+#include "Corpus.hpp"
+
+#include <ArrayBuilder.hpp>
+#include <DataValue.hpp>
+#include <DataPatch.hpp>
+#include <DataParallel.hpp>
+#include <DataSchema.hpp>
+#include <SharedDocument.hpp>
+#include <DataTranslator.hpp>
+#include <TranslationCache.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using serial::DataValue;
+using serial::DataTranslator;
+using serial::FixedView;
+
+namespace sb = serial::benchmark;
+
+namespace {
+
+  //--------------------------------------------------------------------------
+  // Translated Shapes
+  //--------------------------------------------------------------------------
+
+  struct point
+  {
+    int   x;
+    int   y;
+    int   z;
+  };
+
+  struct record
+  {
+    int         id;
+    bool        active;
+    float       score;
+    std::string name;
+    int         x;
+    int         y;
+    int         z;
+  };
+
+  /// \brief A record whose id and score are bound through converters
+  struct wide_record
+  {
+    std::int64_t id;
+    double       score;
+    std::string  name;
+  };
+
+  //--------------------------------------------------------------------------
+  // Argument Parsing
+  //--------------------------------------------------------------------------
+
+  bool parse_option( const char* arg, const char* name, std::string& value )
+  {
+    const std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) != 0 || arg[length] != '=') return false;
+
+    value = arg + length + 1;
+    return true;
+  }
+
+  bool parse_arguments( int argc, char** argv, sb::options& opts )
+  {
+    for(int i = 1; i < argc; ++i){
+      std::string value;
+      if(parse_option(argv[i], "--size", value)){
+        opts.size = std::strtoul(value.c_str(), nullptr, 10);
+      }else if(parse_option(argv[i], "--depth", value)){
+        opts.depth = std::strtoul(value.c_str(), nullptr, 10);
+      }else if(parse_option(argv[i], "--fanout", value)){
+        opts.fanout = std::strtoul(value.c_str(), nullptr, 10);
+      }else if(parse_option(argv[i], "--repetitions", value)){
+        opts.repetitions = std::strtoul(value.c_str(), nullptr, 10);
+      }else if(parse_option(argv[i], "--seed", value)){
+        opts.seed = static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+      }else if(parse_option(argv[i], "--filter", value)){
+        opts.filter = value;
+      }else if(parse_option(argv[i], "--format", value) && value == "csv"){
+        opts.format = sb::options::format_csv;
+      }else if(parse_option(argv[i], "--format", value) && value == "json"){
+        opts.format = sb::options::format_json;
+      }else{
+        std::cerr << "usage: " << argv[0]
+                  << " [--size=N] [--depth=N] [--fanout=N] [--repetitions=N]"
+                     " [--seed=N] [--filter=TEXT] [--format=json|csv]\n";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //--------------------------------------------------------------------------
+  // Benchmarks
+  //--------------------------------------------------------------------------
+
+  void construction_benchmarks( sb::Runner& runner, const sb::options& opts )
+  {
+    const std::size_t tree_nodes = sb::count_nodes(sb::make_tree(opts.depth, opts.fanout, opts.seed));
+
+    runner.run("build/int_array", opts.size, [&]{
+      DataValue value = sb::make_int_array(opts.size, opts.seed);
+      sb::consume(value.size());
+    });
+
+    runner.run("build/int_array_reserved", opts.size, [&]{
+      DataValue value(DataValue::type_array);
+      value.reserve(opts.size);
+      for(std::size_t i = 0; i < opts.size; ++i){
+        value.add_member(DataValue(static_cast<std::int32_t>(i)));
+      }
+      sb::consume(value.size());
+    });
+
+    runner.run("build/flat_object", opts.size, [&]{
+      DataValue value = sb::make_flat_object(opts.size, opts.seed);
+      sb::consume(value.size());
+    });
+
+    runner.run("build/tree", tree_nodes, [&]{
+      DataValue value = sb::make_tree(opts.depth, opts.fanout, opts.seed);
+      sb::consume(value.size());
+    });
+
+    // A shared input buffer of fixed-width words, as a parser would hold
+    const std::size_t word = 24;
+    std::shared_ptr<std::string> buffer = std::make_shared<std::string>();
+    for(std::size_t i = 0; i < opts.size; ++i){
+      buffer->append(sb::make_key(i)).resize((i + 1) * word, '_');
+    }
+
+    runner.run("build/string_copies", opts.size, [&]{
+      DataValue value(DataValue::type_array);
+      DataValue element;
+      for(std::size_t i = 0; i < opts.size; ++i){
+        element.set_string(buffer->substr(i * word, word));
+        value.add_member(element);
+      }
+      sb::consume(value.size());
+    });
+
+    runner.run("build/string_slices", opts.size, [&]{
+      DataValue value(DataValue::type_array);
+      DataValue element;
+      for(std::size_t i = 0; i < opts.size; ++i){
+        element.set_string_view(std::string_view(*buffer).substr(i * word, word), buffer);
+        value.add_member(element);
+      }
+      sb::consume(value.size());
+    });
+
+    runner.run("destroy/tree", tree_nodes,
+      [&]{ return sb::make_tree(opts.depth, opts.fanout, opts.seed); },
+      [](DataValue& value){ value.set_null(); });
+
+    runner.run("copy/tree", 1,
+      [&]{ return sb::make_tree(opts.depth, opts.fanout, opts.seed); },
+      [](DataValue& value){
+        DataValue copy = value;
+        sb::consume(copy.size());
+      });
+
+    runner.run("copy/clone_tree", tree_nodes,
+      [&]{ return sb::make_tree(opts.depth, opts.fanout, opts.seed); },
+      [](DataValue& value){
+        DataValue copy = value.clone();
+        sb::consume(copy.size());
+      });
+  }
+
+  void access_benchmarks( sb::Runner& runner, const sb::options& opts )
+  {
+    const DataValue array  = sb::make_int_array(opts.size, opts.seed);
+    const DataValue object = sb::make_flat_object(opts.size, opts.seed);
+
+    std::vector<std::string> keys;
+    keys.reserve(opts.size);
+    for(std::size_t i = 0; i < opts.size; ++i){
+      keys.push_back(sb::make_key((i * 7919) % opts.size));
+    }
+
+    runner.run("lookup/array_index", opts.size, [&]{
+      std::size_t sum = 0;
+      for(std::size_t i = 0; i < array.size(); ++i){
+        sum += static_cast<std::size_t>(array.at(i).as_int());
+      }
+      sb::consume(sum);
+    });
+
+    runner.run("lookup/object_key", opts.size, [&]{
+      std::size_t sum = 0;
+      for(const auto& key : keys){
+        sum += static_cast<std::size_t>(object.at(key).type());
+      }
+      sb::consume(sum);
+    });
+
+    std::vector<serial::key_handle> handles;
+    handles.reserve(keys.size());
+    for(const auto& key : keys){
+      handles.push_back(serial::KeyTable::intern(key));
+    }
+
+    runner.run("lookup/object_handle", opts.size, [&]{
+      std::size_t sum = 0;
+      for(const auto& handle : handles){
+        sum += static_cast<std::size_t>(object.at(handle).type());
+      }
+      sb::consume(sum);
+    });
+
+    runner.run("lookup/has_member", opts.size, [&]{
+      std::size_t sum = 0;
+      for(const auto& key : keys){
+        sum += object.has_member(key);
+      }
+      sb::consume(sum);
+    });
+
+    const serial::SharedDocument document(object);
+
+    runner.run("lookup/snapshot_handle", opts.size, [&]{
+      std::size_t sum = 0;
+      for(const auto& handle : handles){
+        const auto snapshot = document.read();
+        sum += static_cast<std::size_t>(snapshot->at(handle).type());
+      }
+      sb::consume(sum);
+    });
+
+    runner.run("iterate/array", opts.size, [&]{
+      std::size_t sum = 0;
+      array.for_each_array([&](const DataValue& x){
+        sum += static_cast<std::size_t>(x.as_int());
+      });
+      sb::consume(sum);
+    });
+
+    std::vector<double> column(array.size());
+
+    runner.run("extract/as_double", opts.size, [&]{
+      double sum = 0.0;
+      for(std::size_t i = 0; i < array.size(); ++i){
+        column[i] = array.at(i).as_double();
+        sum += column[i];
+      }
+      sb::consume(static_cast<std::size_t>(sum));
+    });
+
+    runner.run("extract/copy_to_double", opts.size, [&]{
+      sb::consume(array.copy_to(column.data(), column.size()));
+    });
+
+    runner.run("iterate/array_elements", opts.size, [&]{
+      std::size_t sum = 0;
+      for(const DataValue& x : array.elements()){
+        sum += static_cast<std::size_t>(x.as_int());
+      }
+      sb::consume(sum);
+    });
+
+    runner.run("iterate/object", opts.size, [&]{
+      std::size_t sum = 0;
+      object.for_each_object([&](const std::string& key, const DataValue& x){
+        sum += key.size() + static_cast<std::size_t>(x.type());
+      });
+      sb::consume(sum);
+    });
+
+    std::vector<DataValue> reals(opts.size);
+    std::vector<DataValue> texts(opts.size);
+    for(std::size_t i = 0; i < opts.size; ++i){
+      reals[i].set_double(static_cast<double>(array.at(i).as_int()) / 7.0);
+      texts[i].set_string(reals[i].as_string());
+    }
+
+    runner.run("convert/to_chars_double", opts.size, [&]{
+      char buffer[DataValue::max_number_chars];
+      std::size_t sum = 0;
+      for(const DataValue& x : reals){
+        sum += static_cast<std::size_t>(x.to_chars(buffer, buffer + sizeof(buffer)) - buffer);
+      }
+      sb::consume(sum);
+    });
+
+    runner.run("convert/as_double_string", opts.size, [&]{
+      double sum = 0.0;
+      for(const DataValue& x : texts){
+        sum += x.as_double();
+      }
+      sb::consume(static_cast<std::size_t>(sum));
+    });
+  }
+
+  void comparison_benchmarks( sb::Runner& runner, const sb::options& opts )
+  {
+    // Built separately so that no storage is shared between the two
+    const DataValue lhs = sb::make_tree(opts.depth, opts.fanout, opts.seed);
+    const DataValue rhs = sb::make_tree(opts.depth, opts.fanout, opts.seed);
+    const std::size_t nodes = sb::count_nodes(lhs);
+
+    runner.run("compare/equals_tree", nodes, [&]{
+      sb::consume(lhs.equals(rhs));
+    });
+
+    runner.run("compare/compare_tree", nodes, [&]{
+      sb::consume(static_cast<std::size_t>(lhs.compare(rhs)));
+    });
+
+    runner.run("compare/hash_tree", nodes, [&]{
+      sb::consume(lhs.hash());
+    });
+
+    runner.run("introspect/statistics_tree", nodes, [&]{
+      sb::consume(lhs.statistics().total_bytes());
+    });
+
+    const DataValue before = sb::make_flat_object(opts.size, opts.seed);
+    const DataValue after  = sb::make_flat_object(opts.size, opts.seed + 1);
+    const DataValue patch  = serial::diff(before, after);
+
+    runner.run("patch/diff_flat_object", opts.size, [&]{
+      sb::consume(serial::diff(before, after).size());
+    });
+
+    runner.run("patch/apply_flat_object", patch.size(),
+      [&]{ return before; },
+      [&](DataValue& value){ sb::consume(serial::apply_patch(value, patch)); });
+
+    std::vector<serial::key_handle> names;
+    names.reserve(opts.size);
+    for(std::size_t i = 0; i < opts.size; ++i){
+      names.push_back(serial::KeyTable::intern(sb::make_key(i)));
+    }
+
+    // Regroups every record under a key, moving rather than copying them
+    runner.run("restructure/take_records", opts.size,
+      [&]{ return sb::make_records(opts.size, opts.seed); },
+      [&](DataValue& value){
+        DataValue index(DataValue::type_object);
+        for(std::size_t i = value.size(); i > 0; --i){
+          index.add_member(names[i - 1], value.take_member(i - 1));
+        }
+        sb::consume(index.size());
+
+        // Destroyed with the state, outside of the timed region
+        value = std::move(index);
+      });
+  }
+
+  void parallel_benchmarks( sb::Runner& runner, const sb::options& opts )
+  {
+    const DataValue records = sb::make_records(opts.size, opts.seed);
+    const DataValue tree    = sb::make_tree(opts.depth, opts.fanout, opts.seed);
+    const std::size_t nodes = sb::count_nodes(tree);
+
+    // Both variants accumulate atomically, so that only the scheduling differs
+    runner.run("iterate/hash_records", opts.size, [&]{
+      std::atomic<std::size_t> sum(0);
+      for(const DataValue& x : records.elements()){
+        sum.fetch_add(x.hash(), std::memory_order_relaxed);
+      }
+      sb::consume(sum.load());
+    });
+
+    runner.run("parallel/hash_records", opts.size, [&]{
+      std::atomic<std::size_t> sum(0);
+      serial::parallel_for_each_array(records, [&](const DataValue& x){
+        sum.fetch_add(x.hash(), std::memory_order_relaxed);
+      }, 256);
+      sb::consume(sum.load());
+    });
+
+    runner.run("iterate/tree_nodes", nodes, [&]{
+      std::atomic<std::size_t> sum(0);
+      serial::detail::for_each_node(tree, [&](const DataValue& x){
+        sum.fetch_add(static_cast<std::size_t>(x.type()), std::memory_order_relaxed);
+      });
+      sb::consume(sum.load());
+    });
+
+    runner.run("parallel/tree_nodes", nodes, [&]{
+      std::atomic<std::size_t> sum(0);
+      serial::parallel_for_each_node(tree, [&](const DataValue& x){
+        sum.fetch_add(static_cast<std::size_t>(x.type()), std::memory_order_relaxed);
+      });
+      sb::consume(sum.load());
+    });
+
+    // Results of a parallel loop gathered into one array
+    serial::ThreadPool& pool = serial::ThreadPool::instance();
+
+    runner.run("aggregate/locked_array", opts.size, [&]{
+      DataValue result(DataValue::type_array);
+      std::mutex mutex;
+      pool.parallel_for(0, opts.size, serial::default_grain, [&]( std::size_t first, std::size_t last ){
+        for(std::size_t i = first; i < last; ++i){
+          DataValue x(static_cast<std::int32_t>(i));
+          std::lock_guard<std::mutex> lock(mutex);
+          result.add_member(std::move(x));
+        }
+      });
+      sb::consume(result.size());
+    });
+
+    runner.run("aggregate/array_builder", opts.size, [&]{
+      serial::ArrayBuilder builder;
+      pool.parallel_for(0, opts.size, serial::default_grain, [&]( std::size_t first, std::size_t last ){
+        for(std::size_t i = first; i < last; ++i){
+          builder.add_member(DataValue(static_cast<std::int32_t>(i)));
+        }
+      });
+      sb::consume(builder.finish().size());
+    });
+  }
+
+  void validation_benchmarks( sb::Runner& runner, const sb::options& opts )
+  {
+    const DataValue records = sb::make_records(opts.size, opts.seed);
+
+    const auto make_string = []( const char* str ){
+      DataValue result;
+      result.set_string(str);
+      return result;
+    };
+    const auto make_typed = [&]( const char* type ){
+      DataValue result(DataValue::type_object);
+      result.add_member("type", make_string(type));
+      return result;
+    };
+
+    DataValue properties(DataValue::type_object);
+    DataValue id = make_typed("integer");
+    id.add_member("minimum", DataValue(0));
+    properties.add_member("id",     id);
+    properties.add_member("active", make_typed("boolean"));
+    properties.add_member("score",  make_typed("number"));
+    properties.add_member("name",   make_typed("string"));
+    properties.add_member("x",      make_typed("integer"));
+    properties.add_member("y",      make_typed("integer"));
+    properties.add_member("z",      make_typed("integer"));
+
+    DataValue required(DataValue::type_array);
+    required.add_member(make_string("id"));
+    required.add_member(make_string("name"));
+
+    DataValue record_schema = make_typed("object");
+    record_schema.add_member("properties", properties);
+    record_schema.add_member("required", required);
+    record_schema.add_member("additionalProperties", DataValue(false));
+
+    DataValue schema = make_typed("array");
+    schema.add_member("items", record_schema);
+
+    serial::DataSchema validator;
+    validator.compile(schema);
+
+    runner.run("validate/records", opts.size, [&]{
+      sb::consume(validator.validate(records));
+    });
+  }
+
+  void translation_benchmarks( sb::Runner& runner, const sb::options& opts )
+  {
+    const DataValue records = sb::make_records(opts.size, opts.seed);
+
+    DataTranslator<point> point_translator;
+    point_translator.add_member("x", &point::x)
+                    .add_member("y", &point::y)
+                    .add_member("z", &point::z);
+
+    DataTranslator<record> record_translator;
+    record_translator.add_member("id",     &record::id)
+                     .add_member("active", &record::active)
+                     .add_member("score",  &record::score)
+                     .add_member("name",   &record::name)
+                     .add_member("x",      &record::x)
+                     .add_member("y",      &record::y)
+                     .add_member("z",      &record::z);
+
+    runner.run("translate/point", opts.size, [&]{
+      std::size_t matched = 0;
+      point result;
+      records.for_each_array([&](const DataValue& x){
+        matched += static_cast<std::size_t>(point_translator.translate(result, &x));
+      });
+      sb::consume(matched);
+    });
+
+    runner.run("translate/record", opts.size, [&]{
+      std::size_t matched = 0;
+      record result;
+      records.for_each_array([&](const DataValue& x){
+        matched += static_cast<std::size_t>(record_translator.translate(result, &x));
+      });
+      sb::consume(matched);
+    });
+
+    // Repeated payloads, parsed anew each time, so they share no storage
+    DataValue heartbeats(DataValue::type_array);
+    heartbeats.reserve(records.size());
+    for(std::size_t i = 0; i < records.size(); ++i){
+      heartbeats.add_member(records.at(i % 16).clone());
+    }
+
+    runner.run("translate/heartbeats", opts.size, [&]{
+      std::size_t matched = 0;
+      record result;
+      heartbeats.for_each_array([&](const DataValue& x){
+        matched += static_cast<std::size_t>(record_translator.translate(result, &x));
+      });
+      sb::consume(matched);
+    });
+
+    // The same repeated payloads, looked up by their raw bytes before
+    // they are parsed
+    std::vector<std::string> payloads;
+    payloads.reserve(heartbeats.size());
+    heartbeats.for_each_array([&](const DataValue& x){
+      record value;
+      record_translator.translate(value, &x);
+      const std::vector<char> bytes = record_translator.encode(value);
+      payloads.emplace_back(bytes.begin(), bytes.end());
+    });
+
+    runner.run("translate/heartbeats_cached_bytes", opts.size, [&]{
+      serial::TranslationCache<record> cache(record_translator, 64);
+      std::size_t matched = 0;
+      record result;
+      for(std::size_t i = 0; i < payloads.size(); ++i){
+        matched += static_cast<std::size_t>(cache.translate(result, payloads[i],
+          [&]( std::string_view ){ return heartbeats.at(i); }));
+      }
+      sb::consume(matched);
+    });
+
+    DataTranslator<wide_record> wide_translator;
+    wide_translator.add_member("id",    &wide_record::id)
+                   .add_member("score", &wide_record::score)
+                   .add_member("name",  &wide_record::name);
+
+    runner.run("translate/converted_record", opts.size, [&]{
+      std::size_t matched = 0;
+      wide_record result;
+      records.for_each_array([&](const DataValue& x){
+        matched += static_cast<std::size_t>(wide_translator.translate(result, &x));
+      });
+      sb::consume(matched);
+    });
+
+    // The same records, written in the fixed layout of the translator
+    std::vector<std::vector<char>> messages;
+    messages.reserve(records.size());
+    records.for_each_array([&](const DataValue& x){
+      record value;
+      record_translator.translate(value, &x);
+      messages.push_back(record_translator.encode(value));
+    });
+
+    runner.run("layout/decode_record", opts.size, [&]{
+      std::size_t matched = 0;
+      record result;
+      for(const auto& x : messages){
+        matched += static_cast<std::size_t>(
+          record_translator.decode(result, FixedView(x.data(), x.size()))
+        );
+      }
+      sb::consume(matched);
+    });
+
+    const std::size_t score = record_translator.layout().field_id("score");
+
+    runner.run("layout/read_field", opts.size, [&]{
+      double sum = 0.0;
+      for(const auto& x : messages){
+        sum += FixedView(x.data(), x.size()).get_float(score);
+      }
+      sb::consume(static_cast<std::size_t>(sum));
+    });
+  }
+
+} // anonymous namespace
+
+int main( int argc, char** argv )
+{
+  sb::options opts;
+  if(!parse_arguments(argc, argv, opts)){
+    return EXIT_FAILURE;
+  }
+
+  sb::Runner runner(opts);
+
+  construction_benchmarks(runner, opts);
+  access_benchmarks(runner, opts);
+  comparison_benchmarks(runner, opts);
+  parallel_benchmarks(runner, opts);
+  validation_benchmarks(runner, opts);
+  translation_benchmarks(runner, opts);
+
+  runner.report(std::cout);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/**
+ * \file ArrayBuilder.hpp
+ *
+ * Concurrent construction of a single array \c DataValue from many threads
+ *
+ */
+#ifndef SERIAL_ARRAYBUILDER_HPP_
+#define SERIAL_ARRAYBUILDER_HPP_
+
+#include "DataValue.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace serial{
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Collects elements appended concurrently by any number of threads
+  ///        into one array
+  ///
+  /// Every thread appends to a shard of its own, which it finds through a
+  /// thread-local cache, so appends take no lock; only the first append of
+  /// a thread, or its first after appending to another builder, locks to
+  /// find or register its shard. \c finish then
+  /// moves the elements of every shard into a single array without copying
+  /// any of them.
+  ///
+  /// Elements appended by one thread keep their relative order; elements of
+  /// different threads are grouped by thread, in the order in which the
+  /// threads first appended.
+  /////////////////////////////////////////////////////////////////////////////
+  class ArrayBuilder final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs a builder without elements
+    ArrayBuilder();
+
+    ArrayBuilder( const ArrayBuilder& ) = delete;
+    ArrayBuilder& operator=( const ArrayBuilder& ) = delete;
+
+    //-------------------------------------------------------------------------
+    // Modifiers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Appends \p value to the shard of the calling thread
+    ///
+    /// May be called concurrently from any number of threads, but not
+    /// concurrently with \c finish.
+    ///
+    /// \param value the value to append
+    void add_member( const DataValue& value );
+    void add_member( DataValue&& value );
+
+    /// \brief Reserves room for \p n more elements in the shard of the
+    ///        calling thread
+    ///
+    /// \param n the number of elements the calling thread will append
+    void reserve( size_type n );
+
+    /// \brief Moves every appended element into one array, leaving the
+    ///        builder empty and ready for reuse
+    ///
+    /// Each element is moved as a single pointer; no element is copied.
+    /// Must not be called concurrently with appends.
+    ///
+    /// \return the array
+    DataValue finish();
+
+    //-------------------------------------------------------------------------
+    // Observers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Gets the number of threads that have appended since the
+    ///        builder was last finished
+    ///
+    /// \return the number of shards
+    size_type shards() const;
+
+    //-------------------------------------------------------------------------
+    // Private Member Types
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief The elements appended by one thread, on a cache line of its
+    ///        own so that neighbouring shards do not contend
+    struct alignas(64) shard
+    {
+      DataValue values;
+    };
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Gets the shard of the calling thread, registering one if
+    ///        this is its first append
+    DataValue& local();
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    /// Identifies this builder, and the shards since it was last finished,
+    /// in the thread-local caches; never reused
+    std::uint64_t m_generation;
+
+    mutable std::mutex                  m_mutex;   ///< guards registration
+    std::vector<std::unique_ptr<shard>> m_shards;  ///< in registration order
+    std::map<std::thread::id,shard*>    m_threads; ///< the shard of each thread
+  };
+
+} // namespace serial
+
+#endif /* SERIAL_ARRAYBUILDER_HPP_ */
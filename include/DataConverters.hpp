@@ -0,0 +1,159 @@
+/**
+ * \file DataConverters.hpp
+ *
+ * Converters from \c DataValue nodes to member types that the
+ * \c DataTranslator does not bind natively
+ *
+ * A converter is any callable as \c converter(const \c DataValue&, \c U&),
+ * returning either \c void or a \c bool that is \c false if the node could
+ * not be converted, in which case the member must be left unchanged.
+ *
+ */
+#ifndef SERIAL_DATACONVERTERS_HPP_
+#define SERIAL_DATACONVERTERS_HPP_
+
+#include "DataValue.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace serial{
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Converts numbers, and strings that spell finite numbers, to a
+  ///        \c double
+  ///
+  /// Each string is parsed once.
+  /////////////////////////////////////////////////////////////////////////////
+  struct double_converter
+  {
+    bool operator()( const DataValue& x, double& out ) const;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Converts numbers in range, and strings that spell them, to a
+  ///        \c std::int64_t
+  ///
+  /// Doubles are truncated towards zero. Each string is parsed once.
+  /////////////////////////////////////////////////////////////////////////////
+  struct int64_converter
+  {
+    bool operator()( const DataValue& x, std::int64_t& out ) const;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Converts numbers in range, and strings that spell them, to a
+  ///        \c std::uint64_t
+  ///
+  /// Doubles are truncated towards zero. Each string is parsed once.
+  /////////////////////////////////////////////////////////////////////////////
+  struct uint64_converter
+  {
+    bool operator()( const DataValue& x, std::uint64_t& out ) const;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Converts strings to the enumerator of \p Enum with that name
+  ///
+  /// The names are sorted once on construction, so each conversion is a
+  /// binary search without allocating.
+  /////////////////////////////////////////////////////////////////////////////
+  template<typename Enum>
+  class enum_converter final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using value_type = std::pair<std::string,Enum>;
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs a converter from (name, enumerator) pairs
+    ///
+    /// If a name is listed more than once, the first listing is used.
+    ///
+    /// \param names the names of the enumerators
+    enum_converter( std::initializer_list<value_type> names );
+
+    //-------------------------------------------------------------------------
+    // Conversion
+    //-------------------------------------------------------------------------
+  public:
+
+    bool operator()( const DataValue& x, Enum& out ) const;
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    std::vector<value_type> m_names; ///< sorted by name
+  };
+
+  //---------------------------------------------------------------------------
+  // Inline Definitions
+  //---------------------------------------------------------------------------
+
+  inline bool double_converter::operator()( const DataValue& x, double& out ) const
+  {
+    return x.try_as_double(out);
+  }
+
+  inline bool int64_converter::operator()( const DataValue& x, std::int64_t& out ) const
+  {
+    return x.try_as_int64(out);
+  }
+
+  inline bool uint64_converter::operator()( const DataValue& x, std::uint64_t& out ) const
+  {
+    return x.try_as_uint64(out);
+  }
+
+  //---------------------------------------------------------------------------
+  // Template Definitions
+  //---------------------------------------------------------------------------
+
+  template<typename Enum>
+  inline enum_converter<Enum>::enum_converter( std::initializer_list<value_type> names )
+    : m_names(names)
+  {
+    const auto by_name = []( const value_type& lhs, const value_type& rhs ){
+      return lhs.first < rhs.first;
+    };
+    std::stable_sort(m_names.begin(), m_names.end(), by_name);
+
+    const auto same_name = []( const value_type& lhs, const value_type& rhs ){
+      return lhs.first == rhs.first;
+    };
+    m_names.erase(std::unique(m_names.begin(), m_names.end(), same_name), m_names.end());
+  }
+
+  template<typename Enum>
+  inline bool enum_converter<Enum>::operator()( const DataValue& x, Enum& out ) const
+  {
+    if(!x.is_string()) return false;
+
+    const std::string_view name = x.as_string_view();
+    auto it = std::lower_bound(m_names.begin(), m_names.end(), name,
+      []( const value_type& lhs, std::string_view rhs ){
+        return std::string_view(lhs.first) < rhs;
+      });
+    if(it == m_names.end() || it->first != name) return false;
+
+    out = it->second;
+    return true;
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_DATACONVERTERS_HPP_ */
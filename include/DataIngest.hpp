@@ -0,0 +1,327 @@
+/**
+ * \file DataIngest.hpp
+ *
+ * Pipelined loading of files into structures, overlapping reading,
+ * parsing and translating across threads
+ *
+ */
+#ifndef SERIAL_DATAINGEST_HPP_
+#define SERIAL_DATAINGEST_HPP_
+
+#include "DataTranslator.hpp"
+#include "DataValue.hpp"
+#include "MappedFile.hpp"
+#include "detail/BoundedQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace serial{
+
+  /// \brief The number of threads and the depth of the queues of each stage
+  ///        of \c ingest
+  struct ingest_options
+  {
+    std::size_t readers     = 1;    ///< threads opening and mapping files
+    std::size_t parsers     = 0;    ///< threads parsing files; 0 for one per core
+    std::size_t translators = 0;    ///< threads translating; 0 for one per core
+    std::size_t queue_depth = 4;    ///< items buffered between two stages
+    std::size_t chunk_size  = 4096; ///< the most objects translated per chunk
+  };
+
+  /// \brief Objects translated from a contiguous run of the elements of a
+  ///        single file
+  template<class T>
+  struct ingest_chunk
+  {
+    std::size_t    file;    ///< the index of the file in the list of paths
+    std::size_t    first;   ///< the index of the first object in the file
+    std::vector<T> objects; ///< the translated objects
+  };
+
+  /// \brief Counts of what \c ingest processed
+  struct ingest_result
+  {
+    std::size_t files;            ///< files read and parsed
+    std::size_t failed;           ///< files that could not be opened
+    std::size_t parse_failed;     ///< files whose parse threw
+    std::size_t objects;          ///< objects translated
+    std::size_t translate_failed; ///< objects whose translation threw
+  };
+
+  /// \brief Reads, parses and translates the files at \p paths, each stage
+  ///        on its own threads
+  ///
+  /// Readers map each file into memory; parsers call \p parse with its
+  /// contents; translators split a parsed array into chunks of at most
+  /// \c chunk_size elements and translate each element into a
+  /// value-initialized \c T, or translate a parsed object into a single
+  /// \c T. The stages are connected by bounded queues, so a stage that
+  /// falls behind stalls the ones before it rather than letting whole
+  /// files pile up in memory.
+  ///
+  /// \p sink is called on the calling thread with every chunk, in no
+  /// particular order; the file and first index of a chunk say where it
+  /// came from.
+  ///
+  /// A file whose parse throws is skipped, and an object whose translation
+  /// throws is left value-initialized; both are counted in the result. If
+  /// \p sink throws, every stage is stopped and joined before the
+  /// exception propagates, as it is for any other exception a stage
+  /// throws, which is rethrown on the calling thread.
+  ///
+  /// The stages block on I/O and on each other, so they run on threads of
+  /// their own rather than on the \c ThreadPool.
+  ///
+  /// \param translator the translator of the objects
+  /// \param paths      the files to load
+  /// \param parse      callable as \c parse(bytes, owner), returning the
+  ///                   \c DataValue spelled by \c bytes; string slices of
+  ///                   \c bytes must be given \c owner, which keeps the
+  ///                   contents alive
+  /// \param sink       callable as \c sink(ingest_chunk<T>&&)
+  /// \param options    the threads and queue depths of the stages
+  /// \return the counts of files and objects processed
+  template<class T, typename Parse, typename Sink>
+  ingest_result ingest( const DataTranslator<T>& translator,
+                        const std::vector<std::string>& paths,
+                        const Parse& parse,
+                        const Sink& sink,
+                        const ingest_options& options = ingest_options() );
+
+  //---------------------------------------------------------------------------
+  // Template Definitions
+  //---------------------------------------------------------------------------
+
+  namespace detail{
+
+    /// \brief Starts \p count threads running \p body, closing \p queue
+    ///        once the last of them returns
+    ///
+    /// The threads hold copies of \p body and \p fail. An exception
+    /// escaping \p body is passed to \p fail, on the thread that threw it,
+    /// rather than terminating the process.
+    template<typename Queue, typename Func, typename Fail>
+    void start_stage( std::vector<std::thread>& threads,
+                      std::size_t count,
+                      Queue& queue,
+                      const Func& body,
+                      const Fail& fail )
+    {
+      auto remaining = std::make_shared<std::atomic<std::size_t>>(count);
+      for(std::size_t i = 0; i < count; ++i){
+        threads.emplace_back([&queue, body, fail, remaining]{
+          try{
+            body();
+          }catch(...){
+            fail();
+          }
+          if(remaining->fetch_sub(1, std::memory_order_acq_rel) == 1){
+            queue.close();
+          }
+        });
+      }
+    }
+
+  } // namespace detail
+
+  template<class T, typename Parse, typename Sink>
+  inline ingest_result ingest( const DataTranslator<T>& translator,
+                               const std::vector<std::string>& paths,
+                               const Parse& parse,
+                               const Sink& sink,
+                               const ingest_options& options )
+  {
+    struct read_item
+    {
+      std::size_t                       file;
+      std::shared_ptr<const MappedFile> contents;
+    };
+
+    struct parse_item
+    {
+      std::size_t                      file;
+      std::shared_ptr<const DataValue> value;
+      std::size_t                      first;
+      std::size_t                      last;
+    };
+
+    // Owns the queues and threads of the stages. However ingest exits,
+    // every queue is closed, so that no stage stays blocked on another,
+    // and every thread is joined
+    struct pipeline
+    {
+      explicit pipeline( std::size_t depth )
+        : read_queue(depth),
+          parse_queue(depth),
+          chunk_queue(depth)
+      {
+
+      }
+
+      ~pipeline()
+      {
+        stop();
+      }
+
+      /// \brief Stops every stage and waits for its threads
+      void stop()
+      {
+        read_queue.close();
+        parse_queue.close();
+        chunk_queue.close();
+        for(auto& x : threads){
+          if(x.joinable()) x.join();
+        }
+      }
+
+      /// \brief Records the exception being handled, unless one already
+      ///        was, and closes every queue to stop the other stages
+      void fail()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if(!error) error = std::current_exception();
+        }
+        read_queue.close();
+        parse_queue.close();
+        chunk_queue.close();
+      }
+
+      detail::bounded_queue<read_item>       read_queue;
+      detail::bounded_queue<parse_item>      parse_queue;
+      detail::bounded_queue<ingest_chunk<T>> chunk_queue;
+      std::vector<std::thread>               threads;
+      std::mutex                             mutex;
+      std::exception_ptr                     error;
+    };
+
+    const std::size_t cores       = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    const std::size_t readers     = std::max<std::size_t>(options.readers, 1);
+    const std::size_t parsers     = options.parsers ? options.parsers : cores;
+    const std::size_t translators = options.translators ? options.translators : cores;
+    const std::size_t chunk_size  = std::max<std::size_t>(options.chunk_size, 1);
+
+    std::atomic<std::size_t> next_file(0);
+    std::atomic<std::size_t> files(0);
+    std::atomic<std::size_t> failed(0);
+    std::atomic<std::size_t> parse_failed(0);
+    std::atomic<std::size_t> translate_failed(0);
+
+    // Declared after the counters, which its threads use until joined; the
+    // threads copy the stage bodies, which may be destroyed first
+    pipeline stages(options.queue_depth);
+
+    // Each stage returns once the next one has been closed on it
+    const auto read = [&]{
+      for(std::size_t i = next_file++; i < paths.size(); i = next_file++){
+        std::shared_ptr<const MappedFile> contents;
+        try{
+          contents = std::make_shared<const MappedFile>(paths[i]);
+        }catch(...){
+          contents.reset();
+        }
+        if(!contents || !contents->is_open()){
+          ++failed;
+          continue;
+        }
+        if(!stages.read_queue.push(read_item{i, std::move(contents)})) return;
+      }
+    };
+
+    const auto parse_files = [&]{
+      read_item item;
+      while(stages.read_queue.pop(item)){
+        std::shared_ptr<const DataValue> value;
+        try{
+          const std::string_view bytes = item.contents->view();
+          value = std::make_shared<const DataValue>(
+            parse(bytes, std::shared_ptr<const void>(std::move(item.contents)))
+          );
+        }catch(...){
+          item.contents.reset();
+          ++parse_failed;
+          continue;
+        }
+        ++files;
+
+        // Arrays are split so that large files are translated in parallel
+        const std::size_t size = value->is_array() ? value->size() : 1;
+        for(std::size_t first = 0; first < size; first += chunk_size){
+          if(!stages.parse_queue.push(parse_item{item.file, value, first, std::min(first + chunk_size, size)})){
+            return;
+          }
+        }
+      }
+    };
+
+    const auto translate = [&]{
+      const auto translate_one = [&]( T& object, const DataValue* data ){
+        try{
+          translator.translate(object, data);
+        }catch(...){
+          object = T();
+          ++translate_failed;
+        }
+      };
+
+      parse_item item;
+      while(stages.parse_queue.pop(item)){
+        ingest_chunk<T> chunk{item.file, item.first, std::vector<T>()};
+        chunk.objects.reserve(item.last - item.first);
+
+        if(item.value->is_array()){
+          const auto elements = item.value->elements().begin();
+          for(std::size_t i = item.first; i < item.last; ++i){
+            chunk.objects.emplace_back();
+            translate_one(chunk.objects.back(), &elements[i]);
+          }
+        }else{
+          chunk.objects.emplace_back();
+          translate_one(chunk.objects.back(), item.value.get());
+        }
+        item.value.reset();
+        if(!stages.chunk_queue.push(std::move(chunk))) return;
+      }
+    };
+
+    const auto fail = [&stages]{ stages.fail(); };
+
+    stages.threads.reserve(readers + parsers + translators);
+    detail::start_stage(stages.threads, readers, stages.read_queue, read, fail);
+    detail::start_stage(stages.threads, parsers, stages.parse_queue, parse_files, fail);
+    detail::start_stage(stages.threads, translators, stages.chunk_queue, translate, fail);
+
+    ingest_result result{0, 0, 0, 0, 0};
+
+    ingest_chunk<T> chunk;
+    while(stages.chunk_queue.pop(chunk)){
+      result.objects += chunk.objects.size();
+      sink(std::move(chunk));
+    }
+
+    stages.stop();
+    if(stages.error){
+      std::rethrow_exception(stages.error);
+    }
+
+    result.files            = files.load();
+    result.failed           = failed.load();
+    result.parse_failed     = parse_failed.load();
+    result.translate_failed = translate_failed.load();
+    result.objects         -= result.translate_failed;
+    return result;
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_DATAINGEST_HPP_ */
@@ -0,0 +1,182 @@
+/**
+ * \file DataParallel.hpp
+ *
+ * Parallel read-only traversals of \c DataValue trees on a \c ThreadPool
+ *
+ */
+#ifndef SERIAL_DATAPARALLEL_HPP_
+#define SERIAL_DATAPARALLEL_HPP_
+
+#include "DataValue.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace serial{
+
+  /// \brief The default number of elements processed serially per task
+  inline constexpr std::size_t default_grain = 1024;
+
+  /// \brief Calls \p function on every element of \p array, in parallel
+  ///
+  /// Elements are processed in contiguous chunks of at most \p grain
+  /// elements; \p function must be safe to call concurrently, and must not
+  /// modify the tree.
+  ///
+  /// \param array the array to traverse
+  /// \param function callable as \c function(const \c DataValue&)
+  /// \param grain the largest number of elements processed by one task
+  /// \param pool the pool to run on
+  template<typename Func>
+  void parallel_for_each_array( const DataValue& array,
+                                const Func& function,
+                                std::size_t grain = default_grain,
+                                ThreadPool& pool = ThreadPool::instance() );
+
+  /// \brief Calls \p function on every member of \p object, in parallel
+  ///
+  /// The members are first gathered into a flat list, since object storage
+  /// cannot be split without walking it.
+  ///
+  /// \param object the object to traverse
+  /// \param function callable as
+  ///        \c function(const \c std::string&, const \c DataValue&)
+  /// \param grain the largest number of members processed by one task
+  /// \param pool the pool to run on
+  template<typename Func>
+  void parallel_for_each_object( const DataValue& object,
+                                 const Func& function,
+                                 std::size_t grain = default_grain,
+                                 ThreadPool& pool = ThreadPool::instance() );
+
+  /// \brief Calls \p function on every node of the tree rooted at \p root,
+  ///        including \p root, in parallel and in no particular order
+  ///
+  /// The children of the upper levels of the tree are spread across tasks
+  /// until there are several tasks per thread; every subtree below that is
+  /// walked serially by one task.
+  ///
+  /// \param root the root of the tree
+  /// \param function callable as \c function(const \c DataValue&)
+  /// \param pool the pool to run on
+  template<typename Func>
+  void parallel_for_each_node( const DataValue& root,
+                               const Func& function,
+                               ThreadPool& pool = ThreadPool::instance() );
+
+  //---------------------------------------------------------------------------
+  // Template Definitions
+  //---------------------------------------------------------------------------
+
+  namespace detail{
+
+    /// \brief Tasks created per thread, to balance uneven subtrees
+    inline constexpr std::size_t tasks_per_thread = 8;
+
+    /// \brief Walks the tree rooted at \p root serially, with an explicit
+    ///        stack so that deep trees cannot overflow the call stack
+    template<typename Func>
+    void for_each_node( const DataValue& root, const Func& function )
+    {
+      std::vector<const DataValue*> stack(1, &root);
+      while(!stack.empty()){
+        const DataValue& node = *stack.back();
+        stack.pop_back();
+
+        function(node);
+        for(const DataValue& x : node.elements()){
+          stack.push_back(&x);
+        }
+        for(const auto& x : node.members()){
+          stack.push_back(&x.value);
+        }
+      }
+    }
+
+    /// \brief Walks \p node, splitting its children across at most
+    ///        \p budget tasks
+    template<typename Func>
+    void parallel_for_each_node( const DataValue& node,
+                                 const Func& function,
+                                 std::size_t budget,
+                                 ThreadPool& pool )
+    {
+      const std::size_t size = node.size();
+      if(budget <= 1 || size <= 1 || !(node.is_array() || node.is_object())){
+        for_each_node(node, function);
+        return;
+      }
+      function(node);
+
+      std::vector<const DataValue*> children;
+      children.reserve(size);
+      for(const DataValue& x : node.elements()){
+        children.push_back(&x);
+      }
+      for(const auto& x : node.members()){
+        children.push_back(&x.value);
+      }
+
+      const std::size_t grain        = (size + budget - 1) / budget;
+      const std::size_t child_budget = budget / size;
+      pool.parallel_for(0, size, grain, [&]( std::size_t first, std::size_t last ){
+        for(std::size_t i = first; i < last; ++i){
+          parallel_for_each_node(*children[i], function, child_budget, pool);
+        }
+      });
+    }
+
+  } // namespace detail
+
+  template<typename Func>
+  inline void parallel_for_each_array( const DataValue& array,
+                                       const Func& function,
+                                       std::size_t grain,
+                                       ThreadPool& pool )
+  {
+    const auto elements = array.elements();
+    const auto first    = elements.begin();
+
+    pool.parallel_for(0, array.is_array() ? array.size() : 0, grain,
+      [&]( std::size_t begin, std::size_t end ){
+        for(std::size_t i = begin; i < end; ++i){
+          function(first[i]);
+        }
+      });
+  }
+
+  template<typename Func>
+  inline void parallel_for_each_object( const DataValue& object,
+                                        const Func& function,
+                                        std::size_t grain,
+                                        ThreadPool& pool )
+  {
+    std::vector<std::pair<key_handle,const DataValue*>> members;
+    members.reserve(object.is_object() ? object.size() : 0);
+    for(const auto& x : object.members()){
+      members.emplace_back(x.key, &x.value);
+    }
+
+    pool.parallel_for(0, members.size(), grain,
+      [&]( std::size_t begin, std::size_t end ){
+        for(std::size_t i = begin; i < end; ++i){
+          function(members[i].first.name(), *members[i].second);
+        }
+      });
+  }
+
+  template<typename Func>
+  inline void parallel_for_each_node( const DataValue& root,
+                                      const Func& function,
+                                      ThreadPool& pool )
+  {
+    detail::parallel_for_each_node(root, function,
+                                   pool.size() * detail::tasks_per_thread, pool);
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_DATAPARALLEL_HPP_ */
@@ -0,0 +1,47 @@
+/**
+ * \file DataPatch.hpp
+ *
+ * Computing and applying differences between two \c DataValue trees, in the
+ * form of RFC 6902 (JSON Patch) documents
+ *
+ */
+#ifndef SERIAL_DATAPATCH_HPP_
+#define SERIAL_DATAPATCH_HPP_
+
+#include "DataValue.hpp"
+
+namespace serial{
+
+  /// \brief Computes a patch that transforms \p from into \p to
+  ///
+  /// The patch is an array of RFC 6902 operation objects, each holding an
+  /// \c "op" ("add", "remove" or "replace"), a JSON Pointer \c "path" and,
+  /// where required, a \c "value". Objects and arrays are descended into so
+  /// that only changed leaves are emitted; subtrees that still share storage
+  /// with each other (see \c DataValue copy semantics) are skipped in
+  /// constant time. The trees are walked with an explicit stack rather than
+  /// recursively, so deep trees cannot overflow the call stack.
+  ///
+  /// \param from the original value
+  /// \param to   the updated value
+  /// \return the patch, as an array \c DataValue (empty if equal)
+  DataValue diff( const DataValue& from, const DataValue& to );
+
+  /// \brief Applies an RFC 6902 patch to \p target in place
+  ///
+  /// All six RFC 6902 operations are supported ("add", "remove", "replace",
+  /// "move", "copy" and "test"). Only the nodes on the path to each modified
+  /// location are cloned; the rest of the tree is left shared.
+  ///
+  /// Member names added by the patch are interned with
+  /// \c KeyTable::try_intern; an operation adding a new name to a full key
+  /// table fails.
+  ///
+  /// \param target the value to patch
+  /// \param patch  an array of operation objects, as produced by \c diff
+  /// \return \c true on success. On failure \p target is left unchanged
+  bool apply_patch( DataValue& target, const DataValue& patch );
+
+} // namespace serial
+
+#endif /* SERIAL_DATAPATCH_HPP_ */
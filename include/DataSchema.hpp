@@ -0,0 +1,137 @@
+/**
+ * \file DataSchema.hpp
+ *
+ * Validation of \c DataValue trees against a compiled subset of JSON Schema
+ *
+ */
+#ifndef SERIAL_DATASCHEMA_HPP_
+#define SERIAL_DATASCHEMA_HPP_
+
+#include "DataValue.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace serial{
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief A schema compiled into a flat instruction program that validates
+  ///        \c DataValue trees without allocating
+  ///
+  /// The supported JSON Schema keywords are:
+  /// - \c type (a name or an array of names; \c "integer" matches the
+  ///   integral data types and \c "number" matches every numeric type)
+  /// - \c enum
+  /// - \c minimum, \c maximum, \c exclusiveMinimum, \c exclusiveMaximum
+  /// - \c minLength, \c maxLength (in code points)
+  /// - \c items (a single schema), \c minItems, \c maxItems
+  /// - \c properties, \c required, \c additionalProperties (\c false only)
+  ///
+  /// As in JSON Schema, keywords only constrain values of the type they
+  /// apply to; e.g. \c minLength accepts any non-string value. Any other
+  /// validation keyword, such as \c pattern, \c const or \c anyOf, makes
+  /// \c compile fail rather than be skipped; annotations such as \c title
+  /// and \c description are ignored.
+  /////////////////////////////////////////////////////////////////////////////
+  class DataSchema final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs a schema that accepts every value
+    DataSchema();
+
+    //-------------------------------------------------------------------------
+    // Compilation
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Compiles \p schema, replacing the current program
+    ///
+    /// \param schema the JSON Schema document to compile
+    /// \return \c true on success. On failure (a malformed keyword, such as a
+    ///         non-numeric \c minimum or an unknown type name, or an
+    ///         unsupported validation keyword) the previous program is kept
+    bool compile( const DataValue& schema );
+
+    /// \brief Gets the number of instructions in the compiled program
+    ///
+    /// \return the program size
+    size_type instructions() const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Validation
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Validates \p value against the compiled schema
+    ///
+    /// \param value the value to validate
+    /// \return \c true if \p value satisfies the schema
+    bool validate( const DataValue& value ) const;
+
+    //-------------------------------------------------------------------------
+    // Private Member Types
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Operation codes of the compiled program
+    enum opcode : std::uint8_t
+    {
+      op_end,                ///< end of a block
+      op_type,               ///< type mask in 'a'
+      op_enum,               ///< constants [a, a+b)
+      op_minimum,            ///< number >= 'number' ('b' set: >)
+      op_maximum,            ///< number <= 'number' ('b' set: <)
+      op_min_length,         ///< code points >= 'a'
+      op_max_length,         ///< code points <= 'a'
+      op_min_items,          ///< elements >= 'a'
+      op_max_items,          ///< elements <= 'a'
+      op_items,              ///< every element matches block 'a'
+      op_required,           ///< member names[a] exists
+      op_property,           ///< member names[a], if present, matches block 'b'
+      op_closed_properties   ///< every member is one of the names [a, a+b), sorted by name
+    };
+
+    /// \brief A single instruction
+    struct instruction
+    {
+      opcode        op;
+      std::uint32_t a;
+      std::uint32_t b;
+      double        number;
+    };
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    bool compile_block( const DataValue& schema, std::uint32_t& block );
+
+    bool run( std::uint32_t block, const DataValue& value ) const;
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    std::uint32_t            m_root;      ///< the block of the root schema
+    std::vector<instruction> m_program;   ///< every block, each ending in op_end
+    std::vector<key_handle>  m_names;     ///< member names referenced by index
+    std::vector<DataValue>   m_constants; ///< enum values referenced by index
+  };
+
+} // namespace serial
+
+#endif /* SERIAL_DATASCHEMA_HPP_ */
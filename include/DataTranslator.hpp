@@ -11,14 +11,23 @@
 #ifndef SERIAL_DATATRANSLATOR_HPP_
 #define SERIAL_DATATRANSLATOR_HPP_
 
+#include "DataConverters.hpp"
+#include "DataValue.hpp"
+#include "FixedLayout.hpp"
+#include "TranslatorStatistics.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
 #include <string>
 #include <vector>
 #include <map>
 
 namespace serial{
 
-  class DataValue;
-
   /////////////////////////////////////////////////////////////////////////////
   /// \brief Translator to transform a generic \c DataBin object into a
   ///        struct at runtime.
@@ -47,6 +56,11 @@ namespace serial{
     typedef float       value_type::*float_member; ///< Class pointer to float member
     typedef std::string value_type::*string_member;///< Class pointer to string member
 
+    // Member pointers to converted scalar types
+    typedef double        value_type::*double_member; ///< Class pointer to double member
+    typedef std::int64_t  value_type::*int64_member;  ///< Class pointer to int64 member
+    typedef std::uint64_t value_type::*uint64_member; ///< Class pointer to uint64 member
+
     // Member pointers to array types (pointers)
     typedef bool*         value_type::*bool_array;   ///< Class pointer to bool array member
     typedef int*          value_type::*int_array;    ///< Class pointer to int array member
@@ -59,6 +73,26 @@ namespace serial{
     typedef std::vector<float>       value_type::*float_vector; ///< Class pointer to float vector member
     typedef std::vector<std::string> value_type::*string_vector;///< Class pointer to string vector member
 
+    /// \brief A member assigned by a translation, which can be assigned
+    ///        again from the translated object
+    class assignment final{
+      friend class DataTranslator;
+
+      typedef void (*copy_function)( value_type&, const value_type&, const void* );
+
+      assignment( copy_function copy, const void* binding ) noexcept
+        : m_copy(copy),
+          m_binding(binding)
+      {
+
+      }
+
+      copy_function m_copy;    ///< copies the member from one object to another
+      const void*   m_binding; ///< the binding of the member in the translator
+    };
+
+    typedef std::vector<assignment> assignment_list; ///< Members assigned by a translation
+
     //-------------------------------------------------------------------------
     // Constructor / Destructor
     //-------------------------------------------------------------------------
@@ -101,6 +135,30 @@ namespace serial{
     DataTranslator& add_member( const std::string& name, float_vector  member );
     DataTranslator& add_member( const std::string& name, string_vector member );
 
+    // Converted types
+    DataTranslator& add_member( const std::string& name, double_member member );
+    DataTranslator& add_member( const std::string& name, int64_member  member );
+    DataTranslator& add_member( const std::string& name, uint64_member member );
+
+    /// \brief Binds \p member to the input member \p name through
+    ///        \p converter
+    ///
+    /// Converted members receive the input values that none of the built-in
+    /// bindings of the same name accept, including arrays and objects. The
+    /// call to \p converter is compiled into the binding itself, so that
+    /// each converted member costs a single indirect call, with the
+    /// converter inlined behind it. Converted members are not part of
+    /// \c layout().
+    ///
+    /// \param name      the name of the input member
+    /// \param member    the member to populate
+    /// \param converter callable as \c converter(const \c DataValue&, \c U&),
+    ///                  returning \c void or whether the value was converted
+    /// \return reference to \c (*this)
+    template<typename U, typename Converter,
+             typename = std::enable_if_t<std::is_invocable_v<const Converter&,const DataValue&,U&>>>
+    DataTranslator& add_member( const std::string& name, U value_type::*member, Converter converter );
+
     //-------------------------------------------------------------------------
     // Loaders
     //-------------------------------------------------------------------------
@@ -113,6 +171,31 @@ namespace serial{
     /// \return the number of members initialized, -1 on error
     size_type translate( value_type& object, const DataValue* data ) const;
 
+    /// \brief Translates a data bin into a single data structure, recording
+    ///        every member it assigns
+    ///
+    /// The recorded members can later be assigned to another object with
+    /// \c assign, which leaves it as if \p data had been translated into
+    /// it, without translating \p data again.
+    ///
+    /// \param object   The object to be populated with data
+    /// \param data     The data to translate into the structures
+    /// \param assigned The list to append the assigned members to
+    /// \return the number of members initialized, -1 on error
+    size_type translate( value_type& object, const DataValue* data, assignment_list& assigned ) const;
+
+    /// \brief Copies the members that a translation into \p source
+    ///        assigned from \p source to \p object
+    ///
+    /// Members that are not in \p assigned are left unchanged, as they are
+    /// by \c translate. The list is only valid while the translator gains
+    /// no members.
+    ///
+    /// \param object   The object to populate
+    /// \param source   The object the members were translated into
+    /// \param assigned The members recorded by the translation
+    void assign( value_type& object, const value_type& source, const assignment_list& assigned ) const;
+
     /// \brief Translates a single data bin into an array of structures
     ///
     /// \param objects Array of objects to be populated with data
@@ -121,6 +204,65 @@ namespace serial{
     /// \return the number of members initialized, -1 on error
     size_type translate_uniform( value_type* objects, size_type size, const DataValue* data ) const;
 
+    //-------------------------------------------------------------------------
+    // Fixed Layout
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Gets the fixed binary layout of the bound members
+    ///
+    /// Every bound scalar and array member is a field of the layout, with
+    /// ids assigned in the order the members were first added; adding
+    /// members only appends fields, so messages stay readable as the
+    /// translator grows.
+    ///
+    /// \return the layout
+    const FixedLayout& layout() const noexcept;
+
+    /// \brief Writes the bound members of \p object as a message in
+    ///        \c layout()
+    ///
+    /// Single fields can then be read from the message with a \c FixedView
+    /// and the ids from \c layout(), without translating it.
+    ///
+    /// A layout whose slots do not all fit the 16-bit offsets of a message
+    /// cannot be written; rather than silently leaving members out, no
+    /// message is written at all.
+    ///
+    /// \param object the object to write
+    /// \return the message, or an empty buffer if a member could not be
+    ///         written
+    std::vector<char> encode( const value_type& object ) const;
+
+    /// \brief Reads the bound members of \p object from a message in
+    ///        \c layout()
+    ///
+    /// Members whose fields are absent from the message are left unchanged,
+    /// and arrays receive at most their bound size of elements.
+    ///
+    /// \param object the object to populate
+    /// \param view   the message to read
+    /// \return the number of members read
+    size_type decode( value_type& object, const FixedView& view ) const;
+
+    //-------------------------------------------------------------------------
+    // Instrumentation
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Aggregates the counters and latency histogram of every
+    ///        \c translate call made so far, across all threads
+    ///
+    /// \note Statistics are only collected when the library is built with
+    ///       \c SERIAL_TRANSLATOR_INSTRUMENTATION set to \c 1; otherwise this
+    ///       returns all zeros and \c translate carries no overhead
+    ///
+    /// \return the aggregated statistics
+    translator_statistics statistics() const;
+
+    /// \brief Resets all instrumentation counters to zero
+    void reset_statistics();
+
     //-------------------------------------------------------------------------
     // Private Member Types
     //-------------------------------------------------------------------------
@@ -133,22 +275,73 @@ namespace serial{
     typedef std::pair<string_array, size_type> string_array_entry;
 
     // Scalar member mapping
-    typedef std::map<std::string, bool_member>   bool_member_map;
-    typedef std::map<std::string, int_member>    int_member_map;
-    typedef std::map<std::string, float_member>  float_member_map;
-    typedef std::map<std::string, string_member> string_member_map;
+    typedef std::map<key_handle, bool_member>   bool_member_map;
+    typedef std::map<key_handle, int_member>    int_member_map;
+    typedef std::map<key_handle, float_member>  float_member_map;
+    typedef std::map<key_handle, string_member> string_member_map;
 
     // Array member mapping
-    typedef std::map<std::string, bool_array_entry>   bool_array_map;
-    typedef std::map<std::string, int_array_entry>    int_array_map;
-    typedef std::map<std::string, float_array_entry>  float_array_map;
-    typedef std::map<std::string, string_array_entry> string_array_map;
+    typedef std::map<key_handle, bool_array_entry>   bool_array_map;
+    typedef std::map<key_handle, int_array_entry>    int_array_map;
+    typedef std::map<key_handle, float_array_entry>  float_array_map;
+    typedef std::map<key_handle, string_array_entry> string_array_map;
 
     // Vector member mapping
-    typedef std::map<std::string, bool_vector>   bool_vector_map;
-    typedef std::map<std::string, int_vector>    int_vector_map;
-    typedef std::map<std::string, float_vector>  float_vector_map;
-    typedef std::map<std::string, string_vector> string_vector_map;
+    typedef std::map<key_handle, bool_vector>   bool_vector_map;
+    typedef std::map<key_handle, int_vector>    int_vector_map;
+    typedef std::map<key_handle, float_vector>  float_vector_map;
+    typedef std::map<key_handle, string_vector> string_vector_map;
+
+    /// \brief A member populated through a converter
+    struct converter_entry
+    {
+      std::function<bool(const DataValue&,value_type&)> convert;
+      std::function<void(value_type&,const value_type&)> copy; ///< copies the member between objects
+      std::size_t bytes; ///< the size of the member
+    };
+
+    // Converted member mapping
+    typedef std::map<key_handle, converter_entry> converter_member_map;
+
+
+    typedef typename detail::translator_counters::sample_type sample_type;
+
+    /// \brief Visitor assigning a single input member to its binding
+    class member_visitor;
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Calls \p function with the field and binding of every member
+    ///        of \p members whose field holds values of kind \p kind
+    template<typename Map, typename Func>
+    void for_each_field( const Map& members, field_kind kind, const Func& function ) const;
+
+    /// \brief Translates \p data into \p object, appending the assigned
+    ///        members to \p assigned unless it is null
+    size_type translate_members( value_type& object,
+                                 const DataValue* data,
+                                 assignment_list* assigned ) const;
+
+    /// \brief Populates the converted member bound to \p key from \p node
+    ///
+    /// \return \c true if a converter accepted \p node
+    bool convert( value_type& object,
+                  key_handle key,
+                  const DataValue& node,
+                  sample_type& sample,
+                  assignment_list* assigned ) const;
+
+    /// \brief Copies the member bound as \p binding, a \c Member, from
+    ///        \p source to \p object
+    template<typename Member>
+    static void copy_member( value_type& object, const value_type& source, const void* binding );
+
+    /// \brief Copies the converted member bound as \p binding, a
+    ///        \c converter_entry, from \p source to \p object
+    static void copy_converted( value_type& object, const value_type& source, const void* binding );
 
     //-------------------------------------------------------------------------
     // Private Members
@@ -174,6 +367,14 @@ namespace serial{
     int_vector_map    m_int_vector_members;    ///< Vector of int array member pointers
     float_vector_map  m_float_vector_members;  ///< Vector of float array member pointers
     string_vector_map m_string_vector_members; ///< Vector of string array member pointers
+
+    // Converted members
+    converter_member_map m_converter_members; ///< Map of converted members
+
+    FixedLayout m_layout; ///< Fixed binary layout of the members
+
+    // Instrumentation
+    mutable detail::translator_counters m_counters; ///< Translation counters (may be empty)
   };
 
 } // namespace serial
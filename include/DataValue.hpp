@@ -10,8 +10,15 @@
 #ifndef SERIAL_DATAVALUE_HPP_
 #define SERIAL_DATAVALUE_HPP_
 
+#include "KeyTable.hpp"
+#include "detail/DataValueIterator.hpp"
+#include "detail/SharedStorage.hpp"
+
 #include <cstdint>
+#include <cstddef>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 
@@ -21,6 +28,22 @@ namespace serial{
   /// \brief A DataValue contains a piece of generic serialized data from a
   ///        tree
   ///
+  /// Array and object storage is reference counted and copied on write, so
+  /// copying a \c DataValue is constant-time and copies share their subtrees.
+  /// The first mutation through a non-const accessor clones only the levels
+  /// on the path to the modified node. Copies may be handed to other threads,
+  /// since the reference counts are atomic; each thread must own its copy.
+  ///
+  /// Object keys are interned in the \c KeyTable, so each object member
+  /// stores a small \c key_handle rather than its own copy of the key.
+  ///
+  /// String values either own a \c std::string, or are slices referencing
+  /// the characters of an external buffer (see \c set_string_view); both
+  /// behave identically apart from how their characters are stored.
+  ///
+  /// \note A reference returned by a non-const accessor must not be used to
+  ///       mutate the tree after the tree has been copied, since the node it
+  ///       refers to is then shared with the copy.
   ////////////////////////////////////////////////////////////////////////////
   class DataValue final {
 
@@ -47,6 +70,69 @@ namespace serial{
 
     using size_type      = std::size_t;
 
+    /// \brief The largest number of characters \c to_chars writes for a
+    ///        non-string scalar
+    static constexpr size_type max_number_chars = 32;
+
+    /// \brief Flags of the numeric representations that a value fits in,
+    ///        as returned by \c ranges()
+    enum range_flag : std::uint8_t
+    {
+      fits_int      = 1 << 0, ///< in range of std::int32_t
+      fits_uint     = 1 << 1, ///< in range of std::uint32_t
+      fits_int64    = 1 << 2, ///< in range of std::int64_t
+      fits_uint64   = 1 << 3, ///< in range of std::uint64_t
+      fits_double   = 1 << 4, ///< any numeric value
+      fits_integral = fits_int | fits_uint | fits_int64 | fits_uint64
+    };
+
+    /// \brief Random-access iterators over the elements of an array
+    using array_iterator        = detail::element_iterator<DataValue>;
+    using const_array_iterator  = detail::element_iterator<const DataValue>;
+
+    /// \brief Input iterators over the members of an object, yielding
+    ///        proxies with a \c key, \c name() and \c value
+    using object_iterator       = detail::member_iterator<DataValue>;
+    using const_object_iterator = detail::member_iterator<const DataValue>;
+
+    /// \brief Tag passed to a visitor, with the value, for array values
+    struct array_tag{};
+
+    /// \brief Tag passed to a visitor, with the value, for object values
+    struct object_tag{};
+
+    /// \brief Node counts, memory usage and shape of a \c DataValue tree
+    ///
+    /// Byte counts are estimates of heap usage: nodes are counted at
+    /// \c sizeof(DataValue), strings only when their payload is too long for
+    /// the small-string buffer, and container overhead includes the shared
+    /// storage block, element slots and per-member map nodes. Storage shared
+    /// with other copies is counted in full, and reported in
+    /// \c shared_containers.
+    struct shape_statistics
+    {
+      /// \brief Number of buckets in \c key_lengths. Bucket 0 counts empty
+      ///        keys and bucket \c i counts lengths in [2^(i-1), 2^i), with
+      ///        the last bucket holding every longer key
+      static constexpr size_type key_length_buckets = 10;
+
+      size_type nodes[type_object + 1];             ///< node count per data_type
+      size_type node_bytes;                         ///< bytes of DataValue nodes
+      size_type string_bytes;                       ///< bytes of string values (keys are interned)
+      size_type container_bytes;                    ///< bytes of array/object storage
+      size_type max_depth;                          ///< deepest level (root is 0)
+      size_type largest_array;                      ///< elements in the largest array
+      size_type largest_object;                     ///< members in the largest object
+      size_type shared_containers;                  ///< levels shared with a copy
+      size_type key_lengths[key_length_buckets];    ///< histogram of key lengths
+
+      /// \brief Gets the total number of nodes
+      size_type total_nodes() const;
+
+      /// \brief Gets the total estimated bytes
+      size_type total_bytes() const;
+    };
+
     //-------------------------------------------------------------------------
     // Constructor / Destructor
     //-------------------------------------------------------------------------
@@ -87,26 +173,47 @@ namespace serial{
     /// \param x the value to assign to the DataValue
     DataValue( double x );
 
-    /// \brief Assignment operator that moves \c rhs to \c this
+    /// \brief Constructs a \c DataValue by copying another DataValue
     ///
-    /// \note This can be an expensive operation since it will copy the entire
-    ///       tree. This should be avoided in most situations
+    /// This is a constant-time operation; any array or object storage is
+    /// shared with \p x until either side is modified
+    ///
+    /// \param x the DataValue to copy
+    DataValue( const DataValue& x );
+
+    /// \brief Assignment operator that copies \c rhs to \c this
+    ///
+    /// This is a constant-time operation; any array or object storage is
+    /// shared with \p rhs until either side is modified
     ///
     /// \param rhs the right side of the equation
     /// \return reference to (*this)
     DataValue& operator = ( const DataValue& rhs );
 
+    /// \brief Creates a deep copy of this \c DataValue that shares no
+    ///        array or object storage with it
+    ///
+    /// Copying is cheaper when the result is only read or modified in
+    /// places; this is for trees that must not keep the storage of the
+    /// source alive, or that are about to be modified throughout. String
+    /// slices are copied as slices of the same characters. The tree is
+    /// walked with an explicit stack, and arrays are allocated at their
+    /// final size.
+    ///
+    /// \return the copy
+    DataValue clone() const;
+
     //-------------------------------------------------------------------------
 
     /// \brief Constructs a \c DataValue using c++11 move semantics.
     ///
     /// \param x the rvalue reference value to move
-    DataValue( DataValue&& x ) = default;
+    DataValue( DataValue&& x );
 
     /// \brief Assigns a \c DataValue using c++11 move semantics.
     ///
     /// \param x the rvalue reference value to move
-    DataValue& operator = ( DataValue&& rhs ) = default;
+    DataValue& operator = ( DataValue&& rhs );
 
     //-------------------------------------------------------------------------
 
@@ -139,6 +246,39 @@ namespace serial{
     /// \return \c True if empty
     bool empty() const;
 
+    /// \brief Returns the number of elements this array can hold before its
+    ///        storage is reallocated
+    /// \note For non-array values this is the same as \c size()
+    ///
+    /// \return the capacity of this array
+    size_type capacity() const;
+
+    /// \brief Reserves storage for at least \p n elements, so that builders
+    ///        that know the final size avoid repeated reallocation
+    ///
+    /// This is a hint: objects store their members as individual tree
+    /// nodes, which cannot be allocated ahead of time, so reserving on an
+    /// object (or any non-array value) has no effect.
+    ///
+    /// \param n the number of elements to reserve storage for
+    void reserve( size_type n );
+
+    /// \brief Computes node counts, memory usage and shape of this tree in a
+    ///        single non-recursive pass
+    ///
+    /// \return the statistics of this tree
+    shape_statistics statistics() const;
+
+    /// \brief Checks whether this tree nests deeper than \p limit levels,
+    ///        stopping as soon as it does
+    ///
+    /// Untrusted documents can be rejected with this before being handed to
+    /// code that recurses over the tree.
+    ///
+    /// \param limit the greatest accepted depth; this value is at depth 0
+    /// \return \c true if some node is deeper than \p limit
+    bool exceeds_depth( size_type limit ) const;
+
     //-------------------------------------------------------------------------
     // Type Assignment
     //-------------------------------------------------------------------------
@@ -182,6 +322,38 @@ namespace serial{
     /// \param str the value to assign
     void set_string( const std::string& str = std::string() );
 
+    /// \brief Sets the \c DataValue to a string slice referencing \p str
+    ///        without copying it
+    ///
+    /// The caller must keep the characters of \p str alive and unchanged
+    /// for as long as this value, or any copy of it, refers to them; e.g.
+    /// an input buffer that outlives the tree.
+    ///
+    /// \param str the characters to reference
+    void set_string_view( std::string_view str );
+
+    /// \brief Sets the \c DataValue to a string slice referencing \p str,
+    ///        sharing ownership of the buffer holding it
+    ///
+    /// The buffer is released once every slice referencing it is gone, so
+    /// a document can reference a shared input buffer directly.
+    ///
+    /// \param str   the characters to reference
+    /// \param owner the owner of the buffer that contains \p str
+    void set_string_view( std::string_view str, std::shared_ptr<const void> owner );
+
+    /// \brief Sets the \c DataValue to the number spelled by \p str
+    ///
+    /// \p str must be a decimal number in its entirety, as accepted by
+    /// \c std::from_chars; parsing does not depend on the locale and does
+    /// not allocate. Integers become an int, or an int64 or uint64 if too
+    /// large for one, and anything else a finite double; spellings of
+    /// infinities and NaNs, such as "inf" and "nan", are rejected.
+    ///
+    /// \param str the characters to parse
+    /// \return \c true on success; on failure the value is left unchanged
+    bool set_number( std::string_view str );
+
     /// \brief Sets this \c DataValue to an array
     void set_array();
 
@@ -199,7 +371,128 @@ namespace serial{
     /// \param value the DataValue to add to the object
     DataValue& add_member( const std::string& name, const DataValue& value );
 
-    /// \brief Recursively destroys all heap data attached to this \c DataValue
+    /// \brief Add a member to the object
+    ///
+    /// An invalid \p key, such as one refused by \c KeyTable::try_intern,
+    /// adds nothing.
+    ///
+    /// \param key   the interned name of the member
+    /// \param value the DataValue to add to the object
+    DataValue& add_member( key_handle key, const DataValue& value );
+
+    /// \brief Moves \p value to the end of an array-type object
+    ///
+    /// \param value the DataValue to move into the array
+    DataValue& add_member( DataValue&& value );
+
+    /// \brief Moves \p value into the object as the member \p name
+    ///
+    /// \param name  the name of the member
+    /// \param value the DataValue to move into the object
+    DataValue& add_member( const std::string& name, DataValue&& value );
+
+    /// \brief Moves \p value into the object as the member \p key
+    ///
+    /// An invalid \p key adds nothing.
+    ///
+    /// \param key   the interned name of the member
+    /// \param value the DataValue to move into the object
+    DataValue& add_member( key_handle key, DataValue&& value );
+
+    /// \brief Removes the member \p name from the object
+    ///
+    /// \param name the name of the member
+    /// \return \c true if the member was removed
+    bool remove_member( const std::string& name );
+
+    /// \brief Removes the member \p key from the object
+    ///
+    /// \param key the interned name of the member
+    /// \return \c true if the member was removed
+    bool remove_member( key_handle key );
+
+    /// \brief Removes the element at index \p i from the array, shifting
+    ///        the later elements down
+    ///
+    /// Only the pointers to the later elements are moved.
+    ///
+    /// \param i the index of the element
+    /// \return \c true if the element was removed
+    bool erase( size_type i );
+
+    /// \brief Removes the member \p name from the object and returns it
+    ///
+    /// The member is moved out without copying its subtree.
+    ///
+    /// \param name the name of the member
+    /// \return the member, or null if there is none
+    DataValue take_member( const std::string& name );
+
+    /// \brief Removes the member \p key from the object and returns it
+    ///
+    /// \param key the interned name of the member
+    /// \return the member, or null if there is none
+    DataValue take_member( key_handle key );
+
+    /// \brief Removes the element at index \p i from the array and
+    ///        returns it
+    ///
+    /// \param i the index of the element
+    /// \return the element, or null if there is none
+    DataValue take_member( size_type i );
+
+    /// \brief Moves the element at index \p from of the array \p source
+    ///        to index \p i of this array
+    ///
+    /// The node itself changes owner, so neither its subtree nor the node
+    /// is copied. The element is removed from \p source before it is
+    /// inserted, so \p source may be this array. A \c DataValue must not
+    /// be spliced into itself or one of its own children.
+    ///
+    /// \param i      the index to insert at, at most \c size()
+    /// \param source the array to move the element out of
+    /// \param from   the index of the element in \p source
+    /// \return \c true if the element was moved
+    bool splice( size_type i, DataValue& source, size_type from );
+
+    /// \brief Moves every element of the array \p source to index \p i of
+    ///        this array, in order, leaving \p source empty
+    ///
+    /// Only the pointers to the nodes are moved, so this costs a pointer
+    /// move per element of \p source and per later element of this array.
+    ///
+    /// \param i      the index to insert at, at most \c size()
+    /// \param source the array to move the elements out of, which must
+    ///               neither be nor contain this array
+    /// \return \c true if the elements were moved
+    bool splice( size_type i, DataValue& source );
+
+    /// \brief Moves the member \p from of the object \p source into this
+    ///        object as the member \p key, replacing any member \p key
+    ///
+    /// \param key    the interned name of the member in this object
+    /// \param source the object to move the member out of
+    /// \param from   the interned name of the member in \p source
+    /// \return \c true if the member was moved
+    bool splice( key_handle key, DataValue& source, key_handle from );
+
+    /// \brief Moves the member \p from of the object \p source into this
+    ///        object as the member \p name, replacing any member \p name
+    ///
+    /// \p name is only interned once the member is known to be movable, and
+    /// through \c KeyTable::try_intern, so the splice fails rather than
+    /// grow a full key table.
+    ///
+    /// \param name   the name of the member in this object
+    /// \param source the object to move the member out of
+    /// \param from   the name of the member in \p source
+    /// \return \c true if the member was moved
+    bool splice( const std::string& name, DataValue& source, const std::string& from );
+
+    /// \brief Destroys all heap data attached to this \c DataValue
+    ///
+    /// Nested containers are released from an explicit stack, so that
+    /// arbitrarily deep trees cannot overflow the call stack.
     void clear();
 
     //-------------------------------------------------------------------------
@@ -269,10 +562,36 @@ namespace serial{
 
     /// \brief Checks if this \c DataValue is convertible to \p x
     ///
+    /// Scalars are convertible to strings, and strings that spell a number
+    /// (see \c set_number) are convertible to the numeric types that the
+    /// number fits in.
+    ///
     /// \param x the parameter to convert
     /// \return \c true if \c this is convertible to \p x
     bool is_convertable_to( data_type x ) const;
 
+    /// \brief Gets the numeric representations this \c DataValue fits in
+    ///
+    /// The flags are computed once when a number is assigned, so this (and
+    /// every numeric \c is_* query) is a single load; testing the flags of
+    /// many elements against a mask does not branch on their types.
+    ///
+    /// \return a combination of \c range_flag values; \c 0 if not numeric
+    std::uint8_t ranges() const noexcept;
+
+    /// \brief Checks if the array or object storage of this \c DataValue is
+    ///        shared with a copy
+    ///
+    /// \return \c true if a mutation would first clone this level
+    bool is_shared() const;
+
+    /// \brief Checks if this \c DataValue shares its array or object storage
+    ///        with \p x, in which case the two are equal
+    ///
+    /// \param x the value to check against
+    /// \return \c true if both refer to the same storage
+    bool shares_with( const DataValue& x ) const;
+
     //-------------------------------------------------------------------------
     // Type Access
     //-------------------------------------------------------------------------
@@ -295,34 +614,110 @@ namespace serial{
 
     /// \brief Gets this value as an integer
     ///
+    /// Strings are parsed as by \c set_number, and read as 0 if they do not
+    /// spell a number
+    ///
     /// \return this value as an integer
     std::int32_t as_int() const;
 
     /// \brief Gets this value as an unsigned integer
     ///
+    /// Strings are parsed as by \c set_number, and read as 0 if they do not
+    /// spell a number
+    ///
     /// \return this value as an unsigned integer
     std::uint32_t as_uint() const;
 
     /// \brief Gets this value as a 64-bit integer
     ///
+    /// Strings are parsed as by \c set_number, and read as 0 if they do not
+    /// spell a number
+    ///
     /// \return this value as a 64-bit integer
     std::int64_t as_int64() const;
 
     /// \brief Gets this value as an unsigned 64-bit integer
     ///
+    /// Strings are parsed as by \c set_number, and read as 0 if they do not
+    /// spell a number
+    ///
     /// \return this value as an unsigned 64-bit integer
     std::uint64_t as_uint64() const;
 
     /// \brief Gets this value as a double
     ///
+    /// Strings are parsed as by \c set_number, and read as 0 if they do not
+    /// spell a number
+    ///
     /// \return this value as a double
     double as_double() const;
 
+    /// \brief Converts this value to a number if it fits, without parsing
+    ///        a string more than once
+    ///
+    /// Numbers are converted if they fit the target type, doubles being
+    /// truncated towards zero; strings are parsed once, as by
+    /// \c set_number, and converted in the same way. Since \c as_int and
+    /// the like parse a string on every call, a string that is read as a
+    /// number more than once is best converted once with these.
+    ///
+    /// Unlike \c is_convertable_to, booleans, null and containers are not
+    /// converted.
+    ///
+    /// \param out receives the number; left unchanged on failure
+    /// \return \c true if this value was converted
+    bool try_as_int( std::int32_t& out ) const;
+    bool try_as_uint( std::uint32_t& out ) const;
+    bool try_as_int64( std::int64_t& out ) const;
+    bool try_as_uint64( std::uint64_t& out ) const;
+    bool try_as_double( double& out ) const;
+
     /// \brief Gets this value as a \c std::string
     ///
+    /// Scalars are formatted as by \c to_chars; arrays and objects yield an
+    /// empty string
+    ///
     /// \return this value as a \c std::string
     std::string as_string() const;
 
+    /// \brief Writes the textual form of this scalar into [\p first,
+    ///        \p last), without allocating
+    ///
+    /// Numbers are formatted by \c std::to_chars, independent of the locale;
+    /// doubles use the shortest form that parses back to the same value.
+    /// Booleans are written as \c true or \c false, null as nothing, and
+    /// strings as their characters. Non-string values take at most
+    /// \c max_number_chars characters.
+    ///
+    /// \param first the start of the buffer
+    /// \param last  the end of the buffer
+    /// \return one past the last character written, or \c nullptr if the
+    ///         buffer is too small or this is an array or object
+    char* to_chars( char* first, char* last ) const;
+
+    /// \brief Gets the characters of this string value without copying them
+    ///
+    /// \return view of the string, or an empty view if not a string. The
+    ///         view is valid until this value is modified or destroyed
+    std::string_view as_string_view() const;
+
+    /// \brief Checks if this string value is a slice of an external buffer
+    ///
+    /// \return \c true if this is a string created by \c set_string_view
+    bool is_string_view() const;
+
+    /// \brief Gets the characters of this string value without copying them
+    ///
+    /// \note The characters are not guaranteed to be null-terminated
+    ///
+    /// \return pointer to the characters, or \c nullptr if not a string
+    const char* string_data() const;
+
+    /// \brief Gets the length of this string value without copying it
+    ///
+    /// \return the number of bytes in the string, or 0 if not a string
+    size_type string_length() const;
+
     /// \brief Gets this value as an array
     ///
     /// \return this value as an array
@@ -333,6 +728,50 @@ namespace serial{
     /// \return this value as an object
     DataValue* as_object();
 
+    //-------------------------------------------------------------------------
+    // Bulk Extraction
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Copies the leading elements of this array into \p out,
+    ///        converted as by \c as_double()
+    ///
+    /// Copying stops at the first element that is not numeric, which is
+    /// left unwritten. Each element is checked and converted with a single
+    /// test of its range flags and a single dispatch on its type.
+    ///
+    /// \param out the buffer to copy into
+    /// \param count the capacity of \p out
+    /// \return the number of elements copied; if less than
+    ///         <tt>min(count, size())</tt>, the index of the first element
+    ///         that could not be converted. 0 if this is not an array
+    size_type copy_to( double* out, size_type count ) const;
+
+    /// \copydoc copy_to(double*,size_type) const
+    ///
+    /// \note Elements are narrowed to \c float, as by a \c static_cast
+    size_type copy_to( float* out, size_type count ) const;
+
+    /// \brief Copies the leading elements of this array into \p out,
+    ///        converted as by \c as_int()
+    ///
+    /// Copying stops at the first element that is not \c is_int().
+    ///
+    /// \param out the buffer to copy into
+    /// \param count the capacity of \p out
+    /// \return the number of elements copied
+    size_type copy_to( std::int32_t* out, size_type count ) const;
+
+    /// \brief Copies the leading elements of this array into \p out,
+    ///        converted as by \c as_int64()
+    ///
+    /// Copying stops at the first element that is not \c is_int64().
+    ///
+    /// \param out the buffer to copy into
+    /// \param count the capacity of \p out
+    /// \return the number of elements copied
+    size_type copy_to( std::int64_t* out, size_type count ) const;
+
     //-------------------------------------------------------------------------
     // Member Access
     //-------------------------------------------------------------------------
@@ -344,6 +783,27 @@ namespace serial{
     /// \return \c true if found
     bool has_member( const std::string& name ) const;
 
+    /// \brief Checks if this \c DataValue has a member with the key \p key
+    ///
+    /// \param key the interned name of the member
+    /// \return \c true if found
+    bool has_member( key_handle key ) const;
+
+    /// \brief Finds the member with the name \c name
+    ///
+    /// \param name the name of the member to find
+    /// \return pointer to the member, or \c nullptr if this is not an object
+    ///         or has no such member
+    const DataValue* find_member( const std::string& name ) const;
+
+    /// \brief Finds the member with the key \p key, comparing handles rather
+    ///        than key strings
+    ///
+    /// \param key the interned name of the member
+    /// \return pointer to the member, or \c nullptr if this is not an object
+    ///         or has no such member
+    const DataValue* find_member( key_handle key ) const;
+
     /// \brief Retrieves the value at array index i
     ///
     /// \note DataValue must be Array or this method will assert
@@ -376,6 +836,18 @@ namespace serial{
     /// \return the \c DataValue with the given name
     const DataValue& at( const std::string& name ) const;
 
+    /// \brief Retrieves the value with the given key, comparing handles
+    ///        rather than key strings
+    ///
+    /// \note \c DataValue must be Object or this method will assert
+    ///
+    /// \param key the interned name of the member
+    /// \return the \c DataValue with the given key
+    DataValue& at( key_handle key );
+
+    /// \copydoc DataValue::at( key_handle key )
+    const DataValue& at( key_handle key ) const;
+
     /// \copydoc DataValue::at( size_t i )
     DataValue& operator[]( size_t i );
 
@@ -395,11 +867,36 @@ namespace serial{
 
     /// \brief Compares \c this with \p x
     ///
+    /// Object members are compared in key order, keys comparing byte by
+    /// byte, so the ordering of objects is the same in every process. The
+    /// tree is walked with an explicit stack rather than recursively.
+    ///
     /// \param x the value to compare to
     /// \return 0 if \c x equals \c this, negative if \c this is less than \c x,
     ///         and positive if \c this is greater than \c x
     int compare( const DataValue& x ) const;
 
+    /// \brief Checks whether \c this is structurally equal to \p x
+    ///
+    /// This is a faster alternative to \c compare when only equality is
+    /// required; it exits early on type or size mismatches, and skips
+    /// subtrees that are the same node. Like \c compare, it does not
+    /// recurse.
+    ///
+    /// \param x the value to compare to
+    /// \return \c true if \c x equals \c this
+    bool equals( const DataValue& x ) const;
+
+    /// \brief Computes a structural hash of this \c DataValue
+    ///
+    /// Values that compare equal produce the same hash. Callers that check
+    /// the same large trees repeatedly can keep the hash of a previous
+    /// version and compare hashes before falling back to \c equals. The
+    /// tree is walked with an explicit stack rather than recursively.
+    ///
+    /// \return the hash of the whole tree
+    std::size_t hash() const;
+
     /// \brief Returns \c true if \c this is null
     ///
     /// \return \c true if \c this is null
@@ -422,6 +919,54 @@ namespace serial{
     template<typename Func>
     void for_each_object(const Func& function) const;
 
+    /// \brief Iterates through all members within this \c DataValue object,
+    ///        passing each key as its interned \c key_handle
+    ///
+    /// \param function the function to call on each iterated element
+    template<typename Func>
+    void for_each_member(const Func& function) const;
+
+    /// \brief Gets the elements of this array as an iterator range
+    ///
+    /// The iterators are random-access, so the range can be searched with
+    /// early exit, split, or passed to parallel algorithms.
+    ///
+    /// \note The mutable overload first clones this level if it is shared,
+    ///       like any other non-const accessor
+    ///
+    /// \return the elements, or an empty range if this is not an array
+    detail::iterator_range<array_iterator> elements();
+
+    /// \copydoc DataValue::elements()
+    detail::iterator_range<const_array_iterator> elements() const;
+
+    /// \brief Gets the members of this object as an iterator range, in key
+    ///        order
+    ///
+    /// \note The mutable overload first clones this level if it is shared,
+    ///       like any other non-const accessor
+    ///
+    /// \return the members, or an empty range if this is not an object
+    detail::iterator_range<object_iterator> members();
+
+    /// \copydoc DataValue::members()
+    detail::iterator_range<const_object_iterator> members() const;
+
+    /// \brief Calls the overload of \p visitor matching the stored type,
+    ///        dispatching on the type tag exactly once
+    ///
+    /// The visitor is called with \c nullptr for null values, with the
+    /// stored \c bool, \c std::int32_t, \c std::uint32_t, \c std::int64_t,
+    /// \c std::uint64_t, \c double or \c std::string_view for scalars,
+    /// and with \c (array_tag, \c const \c DataValue&) or
+    /// \c (object_tag, \c const \c DataValue&) for containers. Every
+    /// overload must return the same type.
+    ///
+    /// \param visitor the visitor to call
+    /// \return the result of the visitor
+    template<typename Visitor>
+    auto visit(Visitor&& visitor) const -> decltype(visitor(nullptr));
+
     //-------------------------------------------------------------------------
     // Private Member Types
     //-------------------------------------------------------------------------
@@ -429,7 +974,17 @@ namespace serial{
 
     using data_entry     = std::unique_ptr<DataValue>;
     using array_values   = std::vector<data_entry>;
-    using object_values  = std::map<std::string,data_entry>;
+    using object_values  = std::map<key_handle,data_entry>;
+    using shared_array   = detail::shared_storage<array_values>;
+    using shared_object  = detail::shared_storage<object_values>;
+
+    /// \brief Characters of a string value stored in an external buffer
+    struct string_slice
+    {
+      const char*                 data;  ///< the first character
+      size_type                   size;  ///< the number of characters
+      std::shared_ptr<const void> owner; ///< the buffer, if owned
+    };
 
     //-------------------------------------------------------------------------
     // Private Members Types
@@ -448,8 +1003,9 @@ namespace serial{
       void*         m_ptr;    ///<
 
       std::string   m_string; ///<
-      array_values  m_array;  ///<
-      object_values m_object; ///< Object
+      string_slice  m_slice;  ///< String referencing an external buffer
+      shared_array  m_array;  ///< Array (copy-on-write)
+      shared_object m_object; ///< Object (copy-on-write)
 
       data_union() : m_null(nullptr){}
       data_union( std::nullptr_t ) : m_null(nullptr){}
@@ -463,17 +1019,78 @@ namespace serial{
       ~data_union(){}
     } m_data;
 
-    data_type m_type; ///< Tag for the type of data in the union
+    data_type    m_type;   ///< Tag for the type of data in the union
+    std::uint8_t m_ranges; ///< range_flag bits of a numeric value, else 0
+    bool         m_sliced; ///< Whether a string value is stored in m_slice
 
     //-------------------------------------------------------------------------
-    // Private Constructor
+    // Private Member Functions
     //-------------------------------------------------------------------------
   private:
 
-    /// \brief Constructs a \c DataValue by deep-copying another DataValue
+    /// \brief Copies the data of \p x into this null \c DataValue, sharing
+    ///        any array or object storage
     ///
     /// \param x the DataValue to copy
-    DataValue( const DataValue& rhs );
+    void copy_data( const DataValue& x );
+
+    /// \brief Moves the data of \p x into this null \c DataValue, leaving
+    ///        \p x null
+    ///
+    /// \param x the DataValue to move
+    void move_data( DataValue& x );
+
+    /// \brief Moves the nested containers among the children of this
+    ///        container into \p pending, if this is the last owner of its
+    ///        storage
+    ///
+    /// \param pending the subtrees still to be destroyed
+    void release_children( std::vector<data_entry>& pending );
+
+    /// \brief Detaches the node of the element at index \p i of this array
+    ///
+    /// \return the node, or null if there is none
+    data_entry release_element( size_type i );
+
+    /// \brief Detaches the node of the member \p key of this object
+    ///
+    /// \return the node, or null if there is none
+    data_entry release_member( key_handle key );
+
+    /// \brief Compares the types and scalar data of \c this and \p x,
+    ///        without looking at the children of containers
+    int compare_shallow( const DataValue& x ) const;
+
+    /// \brief Checks the types and scalar data of \c this and \p x for
+    ///        equality, without looking at the children of containers
+    bool equals_shallow( const DataValue& x ) const;
+
+    /// \brief Hashes a scalar \c DataValue
+    std::size_t hash_shallow() const;
+
+    /// \brief Gets the array storage for reading
+    const array_values& array_data() const;
+
+    /// \brief Gets the object storage for reading
+    const object_values& object_data() const;
+
+    /// \brief Gets the array storage for writing, cloning this level first
+    ///        if it is shared
+    array_values& mutable_array();
+
+    /// \brief Gets the object storage for writing, cloning this level first
+    ///        if it is shared
+    object_values& mutable_object();
+
+    /// \brief Copies the leading array elements whose range flags contain
+    ///        \p mask into \p out, converted to \p T
+    template<typename T>
+    size_type copy_numbers( T* out, size_type count, std::uint8_t mask ) const;
+
+    /// \brief Converts this number, or the number a string spells, to
+    ///        \p T if its range flags contain \p mask
+    template<typename T>
+    bool try_as_number( T& out, std::uint8_t mask ) const;
 
   };
 
@@ -486,6 +1103,64 @@ namespace serial{
     return m_type;
   }
 
+  inline bool DataValue::is_numeric() const
+  {
+    return (m_ranges & fits_double) != 0;
+  }
+
+  inline bool DataValue::is_integral() const
+  {
+    return (m_ranges & fits_integral) != 0;
+  }
+
+  inline bool DataValue::is_int() const
+  {
+    return (m_ranges & fits_int) != 0;
+  }
+
+  inline bool DataValue::is_uint() const
+  {
+    return (m_ranges & fits_uint) != 0;
+  }
+
+  inline bool DataValue::is_int64() const
+  {
+    return (m_ranges & fits_int64) != 0;
+  }
+
+  inline bool DataValue::is_uint64() const
+  {
+    return (m_ranges & fits_uint64) != 0;
+  }
+
+  inline bool DataValue::is_double() const
+  {
+    return (m_ranges & fits_double) != 0;
+  }
+
+  inline std::uint8_t DataValue::ranges() const noexcept
+  {
+    return m_ranges;
+  }
+
+  inline std::string_view DataValue::as_string_view() const
+  {
+    if(m_type != type_string) return std::string_view();
+
+    return m_sliced ? std::string_view(m_data.m_slice.data, m_data.m_slice.size)
+                    : std::string_view(m_data.m_string);
+  }
+
+  inline const DataValue::array_values& DataValue::array_data() const
+  {
+    return *m_data.m_array;
+  }
+
+  inline const DataValue::object_values& DataValue::object_data() const
+  {
+    return *m_data.m_object;
+  }
+
   inline DataValue& DataValue::operator []( size_t i )
   {
     return at( i );
@@ -512,7 +1187,7 @@ namespace serial{
 
   inline bool operator ==( const DataValue& lhs, const DataValue& rhs )
   {
-    return lhs.compare(rhs) == 0;
+    return lhs.equals(rhs);
   }
 
   inline bool operator <( const DataValue& lhs, const DataValue& rhs )
@@ -540,15 +1215,35 @@ namespace serial{
     return !(rhs == lhs);
   }
 
+  template<typename Visitor>
+  inline auto DataValue::visit(Visitor&& visitor) const -> decltype(visitor(nullptr))
+  {
+    switch(m_type)
+    {
+    case type_bool:   return visitor(m_data.m_bool);
+    case type_int:    return visitor(m_data.m_int);
+    case type_uint:   return visitor(m_data.m_uint);
+    case type_int64:  return visitor(m_data.m_int64);
+    case type_uint64: return visitor(m_data.m_uint64);
+    case type_double: return visitor(m_data.m_double);
+    case type_string: return visitor(as_string_view());
+    case type_array:  return visitor(array_tag(), *this);
+    case type_object: return visitor(object_tag(), *this);
+    case type_null:   break;
+    }
+    return visitor(nullptr);
+  }
+
   template<typename Func>
   inline void DataValue::for_each_array(const Func& function) const
   {
     if(m_type!=type_array){
       // throw
+      return;
     }
 
-    for(const auto& x : m_data.m_array){
-      function(x);
+    for(const auto& x : array_data()){
+      function(*x);
     }
   }
 
@@ -557,13 +1252,59 @@ namespace serial{
   {
     if(m_type!=type_object){
       // throw
+      return;
     }
 
-    for(const auto& x : m_data.m_object){
-      function(x.first,x.second);
+    for(const auto& x : object_data()){
+      function(x.first.name(),*x.second);
     }
   }
 
+  template<typename Func>
+  inline void DataValue::for_each_member(const Func& function) const
+  {
+    if(m_type!=type_object){
+      // throw
+      return;
+    }
+
+    for(const auto& x : object_data()){
+      function(x.first,*x.second);
+    }
+  }
+
+  inline detail::iterator_range<DataValue::array_iterator> DataValue::elements()
+  {
+    if(m_type != type_array) return {};
+
+    array_values& values = mutable_array();
+    return {array_iterator(values.begin()), array_iterator(values.end())};
+  }
+
+  inline detail::iterator_range<DataValue::const_array_iterator> DataValue::elements() const
+  {
+    if(m_type != type_array) return {};
+
+    const array_values& values = array_data();
+    return {const_array_iterator(values.begin()), const_array_iterator(values.end())};
+  }
+
+  inline detail::iterator_range<DataValue::object_iterator> DataValue::members()
+  {
+    if(m_type != type_object) return {};
+
+    object_values& values = mutable_object();
+    return {object_iterator(values.begin()), object_iterator(values.end())};
+  }
+
+  inline detail::iterator_range<DataValue::const_object_iterator> DataValue::members() const
+  {
+    if(m_type != type_object) return {};
+
+    const object_values& values = object_data();
+    return {const_object_iterator(values.begin()), const_object_iterator(values.end())};
+  }
+
 } // namespace serial
 
 #endif /* SERIAL_DATAVALUE_HPP_ */
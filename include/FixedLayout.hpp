@@ -0,0 +1,425 @@
+/**
+ * \file FixedLayout.hpp
+ *
+ * A fixed binary message layout, with fields at precomputed offsets that
+ * are read straight out of the buffer without parsing
+ *
+ * A message is laid out as:
+ *
+ * \code
+ * u32   size                   total size of the message in bytes
+ * u16   fields                 number of entries in the offset table
+ * u16   reserved
+ * u16   offsets[fields]        offset of each field's slot, 0 if absent
+ *       (padding to 4 bytes)
+ *       slots                  fixed-size slots of the fields
+ *       tail                   characters and elements of strings/arrays
+ * \endcode
+ *
+ * Booleans take 1 byte, ints and floats 4 bytes, and strings and arrays a
+ * (u32 offset, u32 length) pair referring into the tail. Arrays of strings
+ * are a sequence of such pairs in the tail. Values are stored in the byte
+ * order of the writer.
+ *
+ * Fields are identified by their index in the offset table. A reader
+ * treats fields past the end of a message's table as absent, so fields may
+ * be appended to a layout without breaking messages written earlier, and
+ * readers that do not know about appended fields ignore them. A field whose
+ * kind changes is given a new id, so its old id is never read as the new
+ * kind.
+ *
+ */
+#ifndef SERIAL_FIXEDLAYOUT_HPP_
+#define SERIAL_FIXEDLAYOUT_HPP_
+
+#include "KeyTable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace serial{
+
+  /// \brief The kinds of values that fields of a \c FixedLayout hold
+  enum class field_kind : std::uint8_t
+  {
+    boolean,      ///< a bool
+    integer,      ///< an int
+    floating,     ///< a float
+    string,       ///< a string
+    bool_array,   ///< an array of bools
+    int_array,    ///< an array of ints
+    float_array,  ///< an array of floats
+    string_array, ///< an array of strings
+  };
+
+  /// \brief The position of a single field in a \c FixedLayout
+  struct field_layout
+  {
+    std::size_t id;     ///< the index of the field in the offset table
+    std::size_t offset; ///< the offset of the slot, from the first slot
+    field_kind  kind;   ///< the kind of value in the slot
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Assigns ids and slots to named fields, in the order in which
+  ///        they are added
+  /////////////////////////////////////////////////////////////////////////////
+  class FixedLayout final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    /// \brief The id returned for names that are not part of the layout
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs a layout without fields
+    FixedLayout();
+
+    //-------------------------------------------------------------------------
+    // Modifiers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Adds the field \p key, holding values of kind \p kind
+    ///
+    /// A field that is added again with the same kind keeps its id. If its
+    /// kind changes, it is given a new id and slot, and its old id is left
+    /// unused, so messages written with the old kind read as if the field
+    /// were absent rather than being misread.
+    ///
+    /// \param key  the interned name of the field
+    /// \param kind the kind of value the field holds
+    /// \return the layout of the field
+    const field_layout& add( key_handle key, field_kind kind );
+
+    //-------------------------------------------------------------------------
+    // Observers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Finds the layout of the field \p key
+    ///
+    /// \param key the interned name of the field
+    /// \return the layout, or \c nullptr if \p key is not a field
+    const field_layout* find( key_handle key ) const;
+
+    /// \brief Gets the id of the field \p name
+    ///
+    /// \param name the name of the field
+    /// \return the id, or \c npos if \p name is not a field
+    size_type field_id( const std::string& name ) const;
+
+    /// \brief Gets the number of entries in the offset table, including
+    ///        the ids left unused by fields that changed kind
+    ///
+    /// \return the number of entries
+    size_type fields() const noexcept;
+
+    /// \brief Gets the offset of the first slot in a message, which follows
+    ///        the header and the offset table
+    ///
+    /// \return the offset of the first slot
+    size_type slots_offset() const noexcept;
+
+    /// \brief Gets the size of a message with no tail
+    ///
+    /// \return the size of the header, offset table and slots
+    size_type fixed_size() const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    std::map<key_handle,field_layout> m_fields;
+    size_type                         m_ids;        ///< ids assigned so far
+    size_type                         m_slots_size; ///< bytes used by slots
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Writes a single message in a \c FixedLayout
+  ///
+  /// Fields that are never set are absent from the message. A message can
+  /// only address 65535 fields, and slots within its first 64 KiB; setting
+  /// a field beyond either limit fails, and is counted by \c dropped.
+  /////////////////////////////////////////////////////////////////////////////
+  class FixedWriter final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Starts a message in \p layout
+    ///
+    /// \param layout the layout of the message
+    explicit FixedWriter( const FixedLayout& layout );
+
+    //-------------------------------------------------------------------------
+    // Modifiers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Sets the scalar field \p field to \p x
+    ///
+    /// \param field the field to set, which must be of the same kind
+    /// \param x     the value
+    /// \return \c false if the field cannot be addressed in the message
+    bool set( const field_layout& field, bool x );
+    bool set( const field_layout& field, int x );
+    bool set( const field_layout& field, float x );
+    bool set( const field_layout& field, std::string_view x );
+
+    /// \brief Sets the array field \p field to the \p count values at
+    ///        \p values
+    ///
+    /// \param field  the field to set, which must be of the same kind
+    /// \param values the values
+    /// \param count  the number of values
+    /// \return \c false if the field cannot be addressed in the message
+    bool set( const field_layout& field, const bool* values, size_type count );
+    bool set( const field_layout& field, const int* values, size_type count );
+    bool set( const field_layout& field, const float* values, size_type count );
+    bool set( const field_layout& field, const std::string* values, size_type count );
+
+    /// \brief Finishes the message
+    ///
+    /// \return the message; the writer is left empty
+    std::vector<char> finish();
+
+    //-------------------------------------------------------------------------
+    // Observers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Gets the number of \c set calls that failed, since their
+    ///        field could not be addressed
+    ///
+    /// \return the number of fields left out of the message
+    size_type dropped() const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Marks \p field as present and gets the offset of its slot
+    ///
+    /// \return the offset, or \c 0 if the slot cannot be addressed, which
+    ///         is counted as dropped
+    size_type slot( const field_layout& field );
+
+    /// \brief Appends \p bytes zeroed bytes to the tail, aligned to
+    ///        \p alignment
+    ///
+    /// \return the offset of the first appended byte
+    size_type append( size_type bytes, size_type alignment );
+
+    /// \brief Stores a (offset,length) reference at \p offset
+    void store_reference( size_type offset, size_type target, size_type length );
+
+    template<typename U>
+    void store( size_type offset, const U& x )
+    {
+      std::memcpy(m_buffer.data() + offset, &x, sizeof(U));
+    }
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    std::vector<char> m_buffer;
+    size_type         m_fields;       ///< the number of entries in the offset table
+    size_type         m_slots_offset; ///< the offset of the first slot
+    size_type         m_dropped;      ///< fields that could not be set
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief A read-only view of a message in a fixed layout
+  ///
+  /// The view does not copy the message, which must outlive it. Every read
+  /// is checked against the bounds of the buffer, so truncated or hostile
+  /// messages read as absent fields rather than out of bounds; fields that
+  /// are absent read as the given fallback, or as empty.
+  /////////////////////////////////////////////////////////////////////////////
+  class FixedView final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Views the \p size bytes at \p data as a message
+    ///
+    /// \param data the message
+    /// \param size the size of the buffer holding the message
+    FixedView( const void* data, size_type size );
+
+    //-------------------------------------------------------------------------
+    // Observers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Checks whether the buffer holds a complete message header
+    ///
+    /// \return \c true if the message is valid
+    bool valid() const noexcept;
+
+    /// \brief Gets the number of fields in the offset table of the message
+    ///
+    /// \return the number of fields
+    size_type fields() const noexcept;
+
+    /// \brief Checks whether field \p id is present
+    ///
+    /// \param id the id of the field
+    /// \return \c true if the field is present
+    bool has_field( size_type id ) const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Scalars
+    //-------------------------------------------------------------------------
+  public:
+
+    bool get_bool( size_type id, bool fallback = false ) const noexcept;
+    int get_int( size_type id, int fallback = 0 ) const noexcept;
+    float get_float( size_type id, float fallback = 0.0f ) const noexcept;
+    std::string_view get_string( size_type id ) const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Arrays
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Gets the number of elements in the array field \p id
+    ///
+    /// The length is checked against the message, so it never exceeds the
+    /// size of the buffer; a length that does not fit reads as \c 0.
+    ///
+    /// \param id the id of the field
+    /// \return the number of elements, or \c 0 if the field is absent or
+    ///         its length is out of bounds
+    size_type get_size( size_type id ) const noexcept;
+
+    bool get_bool_at( size_type id, size_type index ) const noexcept;
+    int get_int_at( size_type id, size_type index ) const noexcept;
+    float get_float_at( size_type id, size_type index ) const noexcept;
+    std::string_view get_string_at( size_type id, size_type index ) const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Gets the offset of the slot of field \p id, if the slot holds
+    ///        \p bytes bytes within the message
+    ///
+    /// \return the offset, or \c 0 if the field is absent
+    size_type slot( size_type id, size_type bytes ) const noexcept;
+
+    /// \brief Reads the (offset,length) reference at \p offset, checking
+    ///        that the \p length elements of \p width bytes are within the
+    ///        message
+    ///
+    /// \return \c true if the reference is valid
+    bool load_reference( size_type offset,
+                         size_type width,
+                         size_type& target,
+                         size_type& length ) const noexcept;
+
+    template<typename U>
+    U load( size_type offset ) const noexcept
+    {
+      U x;
+      std::memcpy(&x, m_data + offset, sizeof(U));
+      return x;
+    }
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    const char* m_data;
+    size_type   m_size;   ///< the size of the message, 0 if invalid
+    size_type   m_fields; ///< the number of entries in the offset table
+  };
+
+  //---------------------------------------------------------------------------
+  // Inline Definitions
+  //---------------------------------------------------------------------------
+
+  inline bool FixedView::valid() const noexcept
+  {
+    return m_size != 0;
+  }
+
+  inline FixedView::size_type FixedView::fields() const noexcept
+  {
+    return m_fields;
+  }
+
+  inline bool FixedView::has_field( size_type id ) const noexcept
+  {
+    return slot(id, 0) != 0;
+  }
+
+  inline FixedView::size_type FixedView::slot( size_type id, size_type bytes ) const noexcept
+  {
+    if(id >= m_fields) return 0;
+
+    // Offset 0 is the header, so it marks absent fields
+    const size_type offset = load<std::uint16_t>(8 + 2 * id);
+    return (offset + bytes <= m_size) ? offset : 0;
+  }
+
+  inline bool FixedView::get_bool( size_type id, bool fallback ) const noexcept
+  {
+    const size_type offset = slot(id, 1);
+    return offset ? (m_data[offset] != 0) : fallback;
+  }
+
+  inline int FixedView::get_int( size_type id, int fallback ) const noexcept
+  {
+    const size_type offset = slot(id, sizeof(std::int32_t));
+    return offset ? static_cast<int>(load<std::int32_t>(offset)) : fallback;
+  }
+
+  inline float FixedView::get_float( size_type id, float fallback ) const noexcept
+  {
+    const size_type offset = slot(id, sizeof(float));
+    return offset ? load<float>(offset) : fallback;
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_FIXEDLAYOUT_HPP_ */
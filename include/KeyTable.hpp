@@ -0,0 +1,261 @@
+/**
+ * \file KeyTable.hpp
+ *
+ * Process-wide table of interned object keys, and the handles that refer
+ * to them
+ *
+ */
+#ifndef SERIAL_KEYTABLE_HPP_
+#define SERIAL_KEYTABLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace serial{
+
+  namespace detail{
+
+    /// \brief A single interned key. Symbols are never freed, so pointers
+    ///        to them stay valid for the lifetime of the process
+    struct key_symbol
+    {
+      const std::string* name;   ///< the key
+      std::size_t        hash;   ///< std::hash of the key
+      std::uint64_t      prefix; ///< the first 8 bytes of the key, big-endian
+      std::uint32_t      id;     ///< the non-zero id of the key
+    };
+
+  } // namespace detail
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief A pre-resolved reference to an interned key
+  ///
+  /// Handles of the same key are equal, and are told apart by an integer
+  /// id. Handles are ordered by their keys, byte by byte, so that objects
+  /// keep their members in the same order in every process; the first 8
+  /// bytes of the key are kept in the handle, so ordering only compares key
+  /// characters when both keys start with the same 8 bytes.
+  ///
+  /// A default constructed handle is invalid, and refers to no key.
+  /////////////////////////////////////////////////////////////////////////////
+  class key_handle final{
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs an invalid handle
+    key_handle() noexcept;
+
+    //-------------------------------------------------------------------------
+    // Observers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Checks if this handle refers to a key
+    ///
+    /// \return \c true if this handle is valid
+    bool valid() const noexcept;
+
+    /// \brief Gets the id of the key
+    ///
+    /// \return the id, or \c 0 if this handle is invalid
+    std::uint32_t id() const noexcept;
+
+    /// \brief Gets the key
+    ///
+    /// \return the key, or an empty string if this handle is invalid
+    const std::string& name() const noexcept;
+
+    /// \brief Gets the precomputed \c std::hash of the key
+    ///
+    /// \return the hash of the key, or \c 0 if this handle is invalid
+    std::size_t hash() const noexcept;
+
+    /// \brief Three-way compares the keys of this handle and \p other
+    ///
+    /// An invalid handle orders before every valid one.
+    ///
+    /// \param other the handle to compare to
+    /// \return 0 if both refer to the same key, negative if the key of this
+    ///         handle orders first, and positive otherwise
+    int compare( const key_handle& other ) const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Private Constructor
+    //-------------------------------------------------------------------------
+  private:
+
+    friend class KeyTable;
+
+    explicit key_handle( const detail::key_symbol* symbol ) noexcept;
+
+    /// \brief Compares the keys of two handles with equal prefixes
+    int compare_names( const key_handle& other ) const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    std::uint64_t             m_prefix; ///< the prefix, kept inline for ordering
+    std::uint32_t             m_id;     ///< the id, kept inline for comparisons
+    const detail::key_symbol* m_symbol; ///< the interned key
+  };
+
+  //---------------------------------------------------------------------------
+  // Comparisons
+  //---------------------------------------------------------------------------
+
+  bool operator == ( const key_handle& lhs, const key_handle& rhs ) noexcept;
+  bool operator != ( const key_handle& lhs, const key_handle& rhs ) noexcept;
+  bool operator <  ( const key_handle& lhs, const key_handle& rhs ) noexcept;
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief The process-wide table of interned keys
+  ///
+  /// The table is safe to use from any number of threads. It is split into
+  /// shards, chosen by the hash of the key. Finding a key takes no lock: each
+  /// shard publishes an open-addressed index of its symbols atomically, and
+  /// only interning a new key locks its shard.
+  ///
+  /// Interned keys are never removed, so that handles never dangle. Keys
+  /// that come from untrusted input should be interned with \c try_intern,
+  /// which stops admitting new keys once the table has grown to \c limit(),
+  /// so that such input cannot grow the table without bound.
+  /////////////////////////////////////////////////////////////////////////////
+  class KeyTable final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    //-------------------------------------------------------------------------
+    // Interning
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Gets the handle of \p name, interning it if needed
+    ///
+    /// \param name the key to intern
+    /// \return the valid handle of \p name
+    static key_handle intern( const std::string& name );
+
+    /// \brief Gets the handle of \p name, interning it only if the table
+    ///        stays within \c limit()
+    ///
+    /// \param name the key to intern
+    /// \return the handle of \p name, or an invalid handle if \p name was
+    ///         not interned and interning it would exceed the limit
+    static key_handle try_intern( const std::string& name );
+
+    /// \brief Gets the handle of \p name without interning it
+    ///
+    /// Since every object key is interned, an invalid result means that no
+    /// object has a member named \p name.
+    ///
+    /// \param name the key to find
+    /// \return the handle of \p name, or an invalid handle if not interned
+    static key_handle find( const std::string& name );
+
+    /// \brief Gets the number of interned keys
+    ///
+    /// \return the number of keys
+    static size_type size();
+
+    /// \brief Gets the approximate number of bytes held by interned keys
+    ///
+    /// \return the number of bytes
+    static size_type bytes();
+
+    /// \brief Gets the most bytes \c try_intern lets the table grow to,
+    ///        which is 16 MiB unless set
+    ///
+    /// \return the limit in bytes
+    static size_type limit();
+
+    /// \brief Sets the most bytes \c try_intern lets the table grow to
+    ///
+    /// Keys interned by \c intern are always admitted, and count towards
+    /// the limit.
+    ///
+    /// \param bytes the limit in bytes
+    static void set_limit( size_type bytes );
+
+    KeyTable() = delete;
+
+    //-------------------------------------------------------------------------
+    // Private Static Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Finds or interns \p name, admitting a new key only if
+    ///        \p bounded is false or the table stays within its limit
+    static key_handle intern( const std::string& name, bool bounded );
+  };
+
+  //---------------------------------------------------------------------------
+  // Inline Definitions
+  //---------------------------------------------------------------------------
+
+  inline key_handle::key_handle() noexcept
+    : m_prefix(0),
+      m_id(0),
+      m_symbol(nullptr)
+  {
+
+  }
+
+  inline key_handle::key_handle( const detail::key_symbol* symbol ) noexcept
+    : m_prefix(symbol->prefix),
+      m_id(symbol->id),
+      m_symbol(symbol)
+  {
+
+  }
+
+  inline bool key_handle::valid() const noexcept
+  {
+    return m_symbol != nullptr;
+  }
+
+  inline std::uint32_t key_handle::id() const noexcept
+  {
+    return m_id;
+  }
+
+  inline std::size_t key_handle::hash() const noexcept
+  {
+    return m_symbol ? m_symbol->hash : 0;
+  }
+
+  inline int key_handle::compare( const key_handle& other ) const noexcept
+  {
+    if(m_id == other.m_id) return 0;
+    if(m_prefix != other.m_prefix) return (m_prefix < other.m_prefix) ? -1 : 1;
+    return compare_names(other);
+  }
+
+  inline bool operator == ( const key_handle& lhs, const key_handle& rhs ) noexcept
+  {
+    return lhs.id() == rhs.id();
+  }
+
+  inline bool operator != ( const key_handle& lhs, const key_handle& rhs ) noexcept
+  {
+    return lhs.id() != rhs.id();
+  }
+
+  inline bool operator < ( const key_handle& lhs, const key_handle& rhs ) noexcept
+  {
+    return lhs.compare(rhs) < 0;
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_KEYTABLE_HPP_ */
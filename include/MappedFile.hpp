@@ -0,0 +1,104 @@
+/**
+ * \file MappedFile.hpp
+ *
+ * Read-only access to the whole contents of a file, mapped into memory
+ * where the platform allows it
+ *
+ */
+#ifndef SERIAL_MAPPEDFILE_HPP_
+#define SERIAL_MAPPEDFILE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace serial{
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief The contents of a file, opened for a single sequential pass
+  ///
+  /// On POSIX systems the file is mapped into memory and the kernel is told
+  /// that it will be read sequentially, so that it reads ahead aggressively
+  /// and drops pages behind the reader. Elsewhere, or if the file cannot be
+  /// mapped, it is read into a buffer with a single read.
+  /////////////////////////////////////////////////////////////////////////////
+  class MappedFile final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    //-------------------------------------------------------------------------
+    // Constructor / Destructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Opens and maps the file at \p path
+    ///
+    /// \param path the path of the file
+    explicit MappedFile( const std::string& path );
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    /// \brief Unmaps the file
+    ~MappedFile();
+
+    //-------------------------------------------------------------------------
+    // Observers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Checks whether the file was opened
+    ///
+    /// \return \c true if the contents of the file are available
+    bool is_open() const noexcept;
+
+    /// \brief Gets the contents of the file
+    ///
+    /// \return the contents, empty if the file is not open
+    std::string_view view() const noexcept;
+
+    /// \brief Gets the size of the file
+    ///
+    /// \return the size in bytes
+    size_type size() const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    const char*       m_data;
+    size_type         m_size;
+    bool              m_open;
+    bool              m_mapped; ///< whether m_data is a mapping to release
+    std::vector<char> m_buffer; ///< the contents, if the file is not mapped
+  };
+
+  //---------------------------------------------------------------------------
+  // Inline Definitions
+  //---------------------------------------------------------------------------
+
+  inline bool MappedFile::is_open() const noexcept
+  {
+    return m_open;
+  }
+
+  inline std::string_view MappedFile::view() const noexcept
+  {
+    return std::string_view(m_data, m_size);
+  }
+
+  inline MappedFile::size_type MappedFile::size() const noexcept
+  {
+    return m_size;
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_MAPPEDFILE_HPP_ */
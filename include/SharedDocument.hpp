@@ -0,0 +1,205 @@
+/**
+ * \file SharedDocument.hpp
+ *
+ * A \c DataValue tree that is read concurrently without locks and replaced
+ * atomically, with epoch-based reclamation of replaced trees
+ *
+ */
+#ifndef SERIAL_SHAREDDOCUMENT_HPP_
+#define SERIAL_SHAREDDOCUMENT_HPP_
+
+#include "DataValue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace serial{
+
+  namespace detail{
+
+    /// \brief The epoch announced by a single reading thread. Records are
+    ///        cache-line aligned so that readers do not contend, and are
+    ///        reused by later threads rather than freed
+    struct alignas(64) reader_record
+    {
+      std::atomic<std::uint64_t> epoch;  ///< announced epoch, or 0 if idle
+      std::atomic<bool>          in_use; ///< whether a thread owns this record
+      std::size_t                depth;  ///< snapshots nested on the owner
+      reader_record*             next;   ///< the next record in the registry
+    };
+
+  } // namespace detail
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Holds the current version of a document, which any number of
+  ///        threads read while a writer publishes replacements
+  ///
+  /// Readers take a \c snapshot, which announces the current epoch in a
+  /// per-thread record and loads the current tree; this takes no lock and
+  /// writes only to memory owned by the reading thread. Publishing swaps
+  /// in the new tree atomically and retires the previous one, which is
+  /// destroyed once every reader that could have seen it has released its
+  /// snapshot. Readers therefore never wait on a reload, and a reload never
+  /// waits on readers.
+  ///
+  /// Writers are serialized by a mutex.
+  ///
+  /// \note Values copied out of a snapshot share storage with the tree and
+  ///       stay valid after the snapshot is released
+  /////////////////////////////////////////////////////////////////////////////
+  class SharedDocument final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A read-only view of the version of a document that was
+    ///        current when the snapshot was taken
+    ///
+    /// A snapshot must be released on the thread that took it. Snapshots
+    /// may be nested, including across documents.
+    ///////////////////////////////////////////////////////////////////////////
+    class snapshot final{
+
+    public:
+
+      snapshot( snapshot&& other ) noexcept;
+
+      snapshot( const snapshot& ) = delete;
+      snapshot& operator=( const snapshot& ) = delete;
+      snapshot& operator=( snapshot&& ) = delete;
+
+      /// \brief Releases the snapshot
+      ~snapshot();
+
+      /// \brief Gets the document
+      const DataValue& operator*() const noexcept;
+
+      /// \brief Gets the document
+      const DataValue* operator->() const noexcept;
+
+      /// \brief Gets the document
+      const DataValue* get() const noexcept;
+
+    private:
+
+      friend class SharedDocument;
+
+      snapshot( detail::reader_record* record, const DataValue* value ) noexcept;
+
+      detail::reader_record* m_record;
+      const DataValue*       m_value;
+    };
+
+    //-------------------------------------------------------------------------
+    // Constructors / Destructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs a document holding \p value
+    ///
+    /// \param value the initial document
+    explicit SharedDocument( DataValue value = DataValue() );
+
+    SharedDocument( const SharedDocument& ) = delete;
+    SharedDocument& operator=( const SharedDocument& ) = delete;
+
+    /// \brief Destroys the current and all retired versions
+    ///
+    /// \note No snapshot of this document may be alive
+    ~SharedDocument();
+
+    //-------------------------------------------------------------------------
+    // Reading
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Takes a snapshot of the current version without locking
+    ///
+    /// \return the snapshot
+    snapshot read() const;
+
+    //-------------------------------------------------------------------------
+    // Writing
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Atomically replaces the current version with \p value
+    ///
+    /// The previous version is retired, and retired versions that no
+    /// reader can still see are destroyed.
+    ///
+    /// \param value the new document
+    void publish( DataValue value );
+
+    /// \brief Destroys the retired versions that no reader can still see
+    ///
+    /// \return the number of versions still waiting for readers
+    size_type reclaim();
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Destroys retired versions; the writer mutex must be held
+    size_type reclaim_locked();
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    using retired_value = std::pair<std::uint64_t,const DataValue*>;
+
+    std::atomic<const DataValue*> m_current; ///< the current version
+    std::mutex                    m_mutex;   ///< serializes writers
+    std::vector<retired_value>    m_retired; ///< versions and the epoch they were retired in
+  };
+
+  //---------------------------------------------------------------------------
+  // Inline Definitions
+  //---------------------------------------------------------------------------
+
+  inline SharedDocument::snapshot::snapshot( detail::reader_record* record,
+                                             const DataValue* value ) noexcept
+    : m_record(record),
+      m_value(value)
+  {
+
+  }
+
+  inline SharedDocument::snapshot::snapshot( snapshot&& other ) noexcept
+    : m_record(other.m_record),
+      m_value(other.m_value)
+  {
+    other.m_record = nullptr;
+    other.m_value  = nullptr;
+  }
+
+  inline const DataValue& SharedDocument::snapshot::operator*() const noexcept
+  {
+    return *m_value;
+  }
+
+  inline const DataValue* SharedDocument::snapshot::operator->() const noexcept
+  {
+    return m_value;
+  }
+
+  inline const DataValue* SharedDocument::snapshot::get() const noexcept
+  {
+    return m_value;
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_SHAREDDOCUMENT_HPP_ */
@@ -0,0 +1,231 @@
+/**
+ * \file ThreadPool.hpp
+ *
+ * A work-stealing thread pool for data-parallel loops
+ *
+ */
+#ifndef SERIAL_THREADPOOL_HPP_
+#define SERIAL_THREADPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace serial{
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief A fixed set of worker threads that execute recursively split
+  ///        loops
+  ///
+  /// Every worker owns a deque of tasks: it pushes and pops work at the
+  /// back, so it keeps working on the most recently split (and cache-warm)
+  /// range, while idle workers steal from the front, taking the largest
+  /// remaining ranges. Threads outside of the pool submit through a shared
+  /// queue, and a thread waiting for a loop to finish executes pending
+  /// tasks, so loops may be nested; it only blocks once no task is queued.
+  /////////////////////////////////////////////////////////////////////////////
+  class ThreadPool final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using size_type = std::size_t;
+
+    //-------------------------------------------------------------------------
+    // Constructor / Destructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs a pool in which \p threads threads, including the
+    ///        thread waiting on a loop, execute tasks
+    ///
+    /// \param threads the number of threads; at least 1
+    explicit ThreadPool( size_type threads = std::thread::hardware_concurrency() );
+
+    ThreadPool( const ThreadPool& ) = delete;
+    ThreadPool& operator=( const ThreadPool& ) = delete;
+
+    /// \brief Stops and joins every worker
+    ~ThreadPool();
+
+    //-------------------------------------------------------------------------
+    // Observers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Gets the process-wide pool, sized to the hardware concurrency
+    ///
+    /// \return the pool
+    static ThreadPool& instance();
+
+    /// \brief Gets the number of threads executing tasks, including the
+    ///        waiting thread
+    ///
+    /// \return the number of threads
+    size_type size() const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Loops
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Calls \p function on disjoint subranges covering
+    ///        [\p first, \p last), each at most \p grain long, in parallel
+    ///
+    /// Ranges are split in half until they are no longer than \p grain, so
+    /// there are O(log n) levels of splitting and idle threads steal large
+    /// pieces. Returns once every subrange is processed.
+    ///
+    /// If \p function throws, subranges that have not started are skipped,
+    /// and the first exception is rethrown once no task of the loop is
+    /// running.
+    ///
+    /// \param first the first index
+    /// \param last one past the last index
+    /// \param grain the largest subrange processed serially
+    /// \param function callable as \c function(first,last)
+    template<typename Func>
+    void parallel_for( size_type first,
+                       size_type last,
+                       size_type grain,
+                       const Func& function );
+
+    //-------------------------------------------------------------------------
+    // Private Member Types
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Counts the outstanding tasks of a single loop, and holds the
+    ///        first exception one of them threw
+    struct task_group
+    {
+      std::atomic<size_type> pending{0};
+      std::atomic<bool>      failed{false};
+      std::exception_ptr     error; ///< written only by the task setting 'failed'
+    };
+
+    struct task
+    {
+      std::function<void()> function;
+      task_group*            group;
+    };
+
+    struct alignas(64) task_queue
+    {
+      std::mutex       mutex;
+      std::deque<task> tasks;
+    };
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    template<typename Func>
+    void split( task_group& group,
+                size_type first,
+                size_type last,
+                size_type grain,
+                const Func& function );
+
+    /// \brief Queues \p function as part of \p group
+    void submit( task_group& group, std::function<void()> function );
+
+    /// \brief Records the exception being handled as the error of \p group,
+    ///        unless it already has one
+    static void fail( task_group& group ) noexcept;
+
+    /// \brief Executes queued tasks until every task of \p group is done,
+    ///        then rethrows the error of \p group, if any
+    void wait( task_group& group );
+
+    /// \brief Marks a task of \p group as done, waking the waiting thread
+    ///        if it was the last
+    void finish( task_group& group );
+
+    /// \brief Executes one queued task, preferring the queue at \p index
+    ///
+    /// \return \c true if a task was executed
+    bool run_one( size_type index );
+
+    /// \brief Gets the queue that the calling thread submits to
+    size_type current_queue() const noexcept;
+
+    void worker( size_type index );
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    /// One queue per worker, followed by the queue of external threads
+    std::vector<std::unique_ptr<task_queue>> m_queues;
+    std::vector<std::thread>                 m_workers;
+
+    std::atomic<size_type>  m_queued;  ///< tasks waiting in any queue
+    std::mutex              m_mutex;   ///< guards sleeping
+    std::condition_variable m_wakeup;  ///< signalled when tasks are queued or
+                                       ///< the last task of a loop is done
+    bool                    m_stop;    ///< whether the pool is shutting down
+  };
+
+  //---------------------------------------------------------------------------
+  // Template Definitions
+  //---------------------------------------------------------------------------
+
+  template<typename Func>
+  inline void ThreadPool::parallel_for( size_type first,
+                                        size_type last,
+                                        size_type grain,
+                                        const Func& function )
+  {
+    if(first >= last) return;
+
+    // Without workers, splitting only adds queueing overhead
+    if(m_workers.empty()){
+      function(first, last);
+      return;
+    }
+
+    // Queued tasks refer to 'group' and 'function', so they must finish
+    // even if the calling thread's own share throws
+    task_group group;
+    try{
+      split(group, first, last, (grain ? grain : 1), function);
+    }catch(...){
+      fail(group);
+    }
+    wait(group);
+  }
+
+  template<typename Func>
+  inline void ThreadPool::split( task_group& group,
+                                 size_type first,
+                                 size_type last,
+                                 size_type grain,
+                                 const Func& function )
+  {
+    // Hand off the upper half and keep splitting the lower half, so that
+    // the largest pieces are the first to be stolen
+    while(last - first > grain){
+      const size_type middle = first + (last - first) / 2;
+      submit(group, [this, &group, middle, last, grain, &function]{
+        split(group, middle, last, grain, function);
+      });
+      last = middle;
+    }
+    function(first, last);
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_THREADPOOL_HPP_ */
@@ -0,0 +1,258 @@
+/**
+ * \file TranslationCache.hpp
+ *
+ * A bounded cache of recent translations, for inputs that repeat
+ *
+ */
+#ifndef SERIAL_TRANSLATIONCACHE_HPP_
+#define SERIAL_TRANSLATIONCACHE_HPP_
+
+#include "DataTranslator.hpp"
+#include "DataValue.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace serial{
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Remembers the results of the most recent translations made
+  ///        with a \c DataTranslator, evicting the least recently used
+  ///
+  /// Inputs are the raw bytes they are parsed from, looked up by a hash of
+  /// the bytes and confirmed by comparing them; a hit is never a different
+  /// input with the same hash. A hit skips parsing as well as translating,
+  /// and costs little more than hashing the bytes. Trees are not cached:
+  /// hashing and comparing a tree walks it much as translating it does.
+  ///
+  /// Each entry keeps the members its translation assigned, and only those
+  /// are copied into the object, so members that the input does not set
+  /// are left unchanged, as they are by \c DataTranslator::translate.
+  /// Converters are called on a value-initialized member, however.
+  ///
+  /// \note The cache is not synchronized; use one cache per thread
+  ///
+  /// \tparam T    the type of the translated objects
+  /// \tparam Hash the hash of the raw inputs
+  /////////////////////////////////////////////////////////////////////////////
+  template<class T, class Hash = std::hash<std::string_view>>
+  class TranslationCache final{
+
+    //-------------------------------------------------------------------------
+    // Public Types
+    //-------------------------------------------------------------------------
+  public:
+
+    using value_type      = T;
+    using translator_type = DataTranslator<T>;
+    using size_type       = typename translator_type::size_type;
+    using hasher          = Hash;
+
+    //-------------------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Constructs an empty cache in front of \p translator
+    ///
+    /// \param translator the translator, which must outlive the cache and
+    ///                   must not gain members while the cache is in use
+    /// \param capacity   the largest number of translations kept
+    /// \param hash       the hash of the raw inputs
+    TranslationCache( const translator_type& translator,
+                      std::size_t capacity,
+                      const hasher& hash = hasher() );
+
+    TranslationCache( const TranslationCache& ) = delete;
+    TranslationCache& operator=( const TranslationCache& ) = delete;
+
+    //-------------------------------------------------------------------------
+    // Translation
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Translates the input spelled by \p bytes into \p object,
+    ///        reusing the previous translation of the same bytes if it is
+    ///        still cached
+    ///
+    /// \p bytes are only parsed when they are not cached.
+    ///
+    /// \param object the object to populate
+    /// \param bytes  the raw input
+    /// \param parse  callable as \c parse(bytes), returning the
+    ///               \c DataValue to translate
+    /// \return the number of members initialized
+    template<typename Parse>
+    size_type translate( value_type& object, std::string_view bytes, const Parse& parse );
+
+    /// \brief Discards every cached translation
+    void clear();
+
+    //-------------------------------------------------------------------------
+    // Observers
+    //-------------------------------------------------------------------------
+  public:
+
+    /// \brief Gets the number of cached translations
+    std::size_t size() const noexcept;
+
+    /// \brief Gets the largest number of cached translations
+    std::size_t capacity() const noexcept;
+
+    /// \brief Gets the number of translations answered from the cache
+    std::size_t hits() const noexcept;
+
+    /// \brief Gets the number of translations made by the translator
+    std::size_t misses() const noexcept;
+
+    //-------------------------------------------------------------------------
+    // Private Member Types
+    //-------------------------------------------------------------------------
+  private:
+
+    using assignment_list = typename translator_type::assignment_list;
+
+    struct entry
+    {
+      std::size_t     hash;
+      std::string     bytes;    ///< the raw input
+      value_type      result;
+      size_type       matched;  ///< the result of the translation
+      assignment_list assigned; ///< the members of \c result translated
+    };
+
+    using entry_list = std::list<entry>;
+
+    //-------------------------------------------------------------------------
+    // Private Member Functions
+    //-------------------------------------------------------------------------
+  private:
+
+    /// \brief Caches the translation \p input as the most recently used
+    ///        entry, replacing any entry with the same hash
+    void insert( entry input );
+
+    //-------------------------------------------------------------------------
+    // Private Members
+    //-------------------------------------------------------------------------
+  private:
+
+    const translator_type& m_translator;
+    std::size_t            m_capacity;
+    hasher                 m_hash;
+
+    entry_list m_entries; ///< most recently used first
+    std::unordered_map<std::size_t,typename entry_list::iterator> m_index;
+
+    std::size_t m_hits;
+    std::size_t m_misses;
+  };
+
+  //---------------------------------------------------------------------------
+  // Template Definitions
+  //---------------------------------------------------------------------------
+
+  template<class T, class Hash>
+  inline TranslationCache<T,Hash>::TranslationCache( const translator_type& translator,
+                                                     std::size_t capacity,
+                                                     const hasher& hash )
+    : m_translator(translator),
+      m_capacity(capacity),
+      m_hash(hash),
+      m_hits(0),
+      m_misses(0)
+  {
+
+  }
+
+  template<class T, class Hash>
+  template<typename Parse>
+  inline typename TranslationCache<T,Hash>::size_type
+  TranslationCache<T,Hash>::translate( value_type& object,
+                                       std::string_view bytes,
+                                       const Parse& parse )
+  {
+    const std::size_t hash = m_hash(bytes);
+
+    auto it = m_index.find(hash);
+    if(it != m_index.end() && it->second->bytes == bytes){
+      ++m_hits;
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      m_translator.assign(object, it->second->result, it->second->assigned);
+      return it->second->matched;
+    }
+    ++m_misses;
+
+    const DataValue data = parse(bytes);
+
+    entry input{hash, std::string(bytes), value_type{}, 0, assignment_list()};
+    input.matched = m_translator.translate(input.result, &data, input.assigned);
+    m_translator.assign(object, input.result, input.assigned);
+
+    const size_type matched = input.matched;
+    insert(std::move(input));
+    return matched;
+  }
+
+  template<class T, class Hash>
+  inline void TranslationCache<T,Hash>::clear()
+  {
+    m_index.clear();
+    m_entries.clear();
+  }
+
+  //---------------------------------------------------------------------------
+
+  template<class T, class Hash>
+  inline std::size_t TranslationCache<T,Hash>::size() const noexcept
+  {
+    return m_entries.size();
+  }
+
+  template<class T, class Hash>
+  inline std::size_t TranslationCache<T,Hash>::capacity() const noexcept
+  {
+    return m_capacity;
+  }
+
+  template<class T, class Hash>
+  inline std::size_t TranslationCache<T,Hash>::hits() const noexcept
+  {
+    return m_hits;
+  }
+
+  template<class T, class Hash>
+  inline std::size_t TranslationCache<T,Hash>::misses() const noexcept
+  {
+    return m_misses;
+  }
+
+  //---------------------------------------------------------------------------
+
+  template<class T, class Hash>
+  inline void TranslationCache<T,Hash>::insert( entry input )
+  {
+    if(m_capacity == 0) return;
+
+    // An input with the same hash as a different one replaces it
+    auto it = m_index.find(input.hash);
+    if(it != m_index.end()){
+      m_entries.erase(it->second);
+      m_index.erase(it);
+    }else if(m_entries.size() >= m_capacity){
+      m_index.erase(m_entries.back().hash);
+      m_entries.pop_back();
+    }
+
+    m_entries.push_front(std::move(input));
+    m_index.emplace(m_entries.front().hash, m_entries.begin());
+  }
+
+} // namespace serial
+
+#endif /* SERIAL_TRANSLATIONCACHE_HPP_ */
@@ -0,0 +1,224 @@
+/**
+ * \file TranslatorStatistics.hpp
+ *
+ * Optional instrumentation of \c DataTranslator, enabled at compile time by
+ * defining \c SERIAL_TRANSLATOR_INSTRUMENTATION to \c 1
+ *
+ */
+#ifndef SERIAL_TRANSLATORSTATISTICS_HPP_
+#define SERIAL_TRANSLATORSTATISTICS_HPP_
+
+#ifndef SERIAL_TRANSLATOR_INSTRUMENTATION
+# define SERIAL_TRANSLATOR_INSTRUMENTATION 0
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+
+namespace serial{
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief Aggregated counters and latency histogram of a \c DataTranslator
+  ///
+  /// The latency histogram is log-linear (HDR-style): values below 4ns have
+  /// their own bucket, and every power of two above that is split into 4
+  /// linear sub-buckets, giving a relative error of at most 25%.
+  /////////////////////////////////////////////////////////////////////////////
+  struct translator_statistics
+  {
+    /// \brief The number of buckets in \c latency
+    static constexpr std::size_t latency_buckets = 160;
+
+    std::uint64_t translations;             ///< calls to translate
+    std::uint64_t matched;                  ///< input members assigned to a binding
+    std::uint64_t unknown_keys;             ///< input members with no binding
+    std::uint64_t type_mismatches;          ///< input members bound with another type
+    std::uint64_t bytes_copied;             ///< bytes written into translated objects
+    std::uint64_t latency[latency_buckets]; ///< translate latency histogram, in ns
+
+    /// \brief Gets the bucket that a latency of \p nanoseconds is recorded in
+    ///
+    /// \param nanoseconds the latency
+    /// \return the bucket index
+    static std::size_t latency_bucket( std::uint64_t nanoseconds ) noexcept;
+
+    /// \brief Gets the largest latency recorded in bucket \p bucket
+    ///
+    /// \param bucket the bucket index
+    /// \return the upper bound of the bucket, in nanoseconds
+    static std::uint64_t latency_upper_bound( std::size_t bucket ) noexcept;
+
+    /// \brief Gets the latency below which \p percentile percent of the
+    ///        recorded translations fall
+    ///
+    /// \param percentile the percentile, in [0,100]
+    /// \return the upper bound of the bucket holding the percentile, in ns
+    std::uint64_t latency_percentile( double percentile ) const noexcept;
+  };
+
+  namespace detail{
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Counts of a single translation, accumulated on the stack and
+    ///        published once at the end of the call
+    ///////////////////////////////////////////////////////////////////////////
+    class TranslationSample final{
+
+    public:
+
+      TranslationSample() noexcept;
+
+      /// \brief Records an input member that was assigned \p bytes bytes
+      void matched( std::size_t bytes ) noexcept;
+
+      /// \brief Records an input member that was not assigned
+      ///
+      /// \param is_bound callable returning whether the key has a binding of
+      ///                 another type
+      template<typename Fn>
+      void missed( const Fn& is_bound );
+
+    private:
+
+      friend class TranslatorCounters;
+
+      std::chrono::steady_clock::time_point m_start;
+      std::uint64_t m_matched;
+      std::uint64_t m_unknown_keys;
+      std::uint64_t m_type_mismatches;
+      std::uint64_t m_bytes_copied;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Striped atomic counters of a single translator
+    ///
+    /// Each thread publishes into its own cache-line aligned stripe, so
+    /// concurrent translations do not contend; the stripes are summed on
+    /// demand by \c aggregate.
+    ///////////////////////////////////////////////////////////////////////////
+    class TranslatorCounters final{
+
+    public:
+
+      typedef TranslationSample sample_type;
+
+      TranslatorCounters() noexcept;
+
+      /// \brief Copies keep the bound names but start with zeroed counters,
+      ///        since counters belong to one translator
+      TranslatorCounters( const TranslatorCounters& other );
+
+      TranslatorCounters& operator=( const TranslatorCounters& other );
+
+      /// \brief Registers \p name as bound to a member, of any type
+      void bind( const std::string& name );
+
+      /// \brief Checks if \p name is bound to a member, of any type
+      bool is_bound( const std::string& name ) const;
+
+      /// \brief Publishes \p sample, timing it from its construction
+      void record( const sample_type& sample ) noexcept;
+
+      /// \brief Sums all stripes
+      translator_statistics aggregate() const noexcept;
+
+      /// \brief Zeroes all stripes
+      void reset() noexcept;
+
+    private:
+
+      static constexpr std::size_t stripes = 16;
+
+      struct alignas(64) stripe
+      {
+        std::atomic<std::uint64_t> translations;
+        std::atomic<std::uint64_t> matched;
+        std::atomic<std::uint64_t> unknown_keys;
+        std::atomic<std::uint64_t> type_mismatches;
+        std::atomic<std::uint64_t> bytes_copied;
+        std::atomic<std::uint64_t> latency[translator_statistics::latency_buckets];
+      };
+
+      stripe                m_stripes[stripes];
+      std::set<std::string> m_bindings;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Stand-in for \c TranslationSample when instrumentation is
+    ///        compiled out; every operation is an empty inline function
+    ///////////////////////////////////////////////////////////////////////////
+    class NullTranslationSample final{
+
+    public:
+
+      void matched( std::size_t ) noexcept{}
+
+      template<typename Fn>
+      void missed( const Fn& ) noexcept{}
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Stand-in for \c TranslatorCounters when instrumentation is
+    ///        compiled out
+    ///////////////////////////////////////////////////////////////////////////
+    class NullTranslatorCounters final{
+
+    public:
+
+      typedef NullTranslationSample sample_type;
+
+      void bind( const std::string& ) noexcept{}
+
+      bool is_bound( const std::string& ) const noexcept{ return false; }
+
+      void record( const sample_type& ) noexcept{}
+
+      translator_statistics aggregate() const noexcept{ return translator_statistics(); }
+
+      void reset() noexcept{}
+    };
+
+#if SERIAL_TRANSLATOR_INSTRUMENTATION
+    typedef TranslatorCounters     translator_counters;
+#else
+    typedef NullTranslatorCounters translator_counters;
+#endif
+
+    //-------------------------------------------------------------------------
+    // Inline Definitions
+    //-------------------------------------------------------------------------
+
+    inline TranslationSample::TranslationSample() noexcept
+      : m_start(std::chrono::steady_clock::now()),
+        m_matched(0),
+        m_unknown_keys(0),
+        m_type_mismatches(0),
+        m_bytes_copied(0)
+    {
+
+    }
+
+    inline void TranslationSample::matched( std::size_t bytes ) noexcept
+    {
+      ++m_matched;
+      m_bytes_copied += bytes;
+    }
+
+    template<typename Fn>
+    inline void TranslationSample::missed( const Fn& is_bound )
+    {
+      if(is_bound()){
+        ++m_type_mismatches;
+      }else{
+        ++m_unknown_keys;
+      }
+    }
+
+  } // namespace detail
+} // namespace serial
+
+#endif /* SERIAL_TRANSLATORSTATISTICS_HPP_ */
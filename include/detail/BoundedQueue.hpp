@@ -0,0 +1,96 @@
+/**
+ * \file BoundedQueue.hpp
+ *
+ * A blocking FIFO queue of limited capacity, connecting the stages of a
+ * pipeline
+ *
+ */
+#ifndef SERIAL_DETAIL_BOUNDEDQUEUE_HPP_
+#define SERIAL_DETAIL_BOUNDEDQUEUE_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace serial{
+  namespace detail{
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A queue whose producers block while it is full, and whose
+    ///        consumers block while it is empty
+    ///
+    /// The queue is closed by its producers once they are done; consumers
+    /// then drain what is left, and producers that are still pushing give
+    /// up.
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    class bounded_queue final{
+
+    public:
+
+      /// \brief Constructs an open queue holding at most \p capacity items
+      explicit bounded_queue( std::size_t capacity )
+        : m_capacity(capacity ? capacity : 1),
+          m_closed(false)
+      {
+
+      }
+
+      /// \brief Appends \p x, waiting for room
+      ///
+      /// \return \c false if the queue was closed instead
+      bool push( T x )
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_full.wait(lock, [this]{ return m_closed || m_items.size() < m_capacity; });
+        if(m_closed) return false;
+
+        m_items.push_back(std::move(x));
+        lock.unlock();
+        m_not_empty.notify_one();
+        return true;
+      }
+
+      /// \brief Removes the oldest item into \p x, waiting for one
+      ///
+      /// \return \c false if the queue is closed and empty
+      bool pop( T& x )
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [this]{ return m_closed || !m_items.empty(); });
+        if(m_items.empty()) return false;
+
+        x = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_not_full.notify_one();
+        return true;
+      }
+
+      /// \brief Closes the queue, waking every waiting thread
+      void close()
+      {
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_closed = true;
+        }
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+      }
+
+    private:
+
+      std::mutex              m_mutex;
+      std::condition_variable m_not_full;
+      std::condition_variable m_not_empty;
+      std::deque<T>           m_items;
+      std::size_t             m_capacity;
+      bool                    m_closed;
+    };
+
+  } // namespace detail
+} // namespace serial
+
+#endif /* SERIAL_DETAIL_BOUNDEDQUEUE_HPP_ */
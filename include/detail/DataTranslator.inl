@@ -1,7 +1,102 @@
 namespace serial{
 
+  //---------------------------------------------------------------------------
+  // Member Visitor
+  //---------------------------------------------------------------------------
+
   template<class T>
-  inline DataTranslator<T>::DataTranslator() noexcept
+  class DataTranslator<T>::member_visitor final{
+
+  public:
+
+    member_visitor( const this_type& translator,
+                    value_type& object,
+                    key_handle key,
+                    sample_type& sample,
+                    assignment_list* assigned )
+      : m_translator(translator),
+        m_object(object),
+        m_key(key),
+        m_sample(sample),
+        m_assigned(assigned)
+    {
+
+    }
+
+    bool operator()( std::nullptr_t ) const
+    {
+      return false;
+    }
+
+    bool operator()( bool x ) const
+    {
+      return assign(m_translator.m_bool_members, x);
+    }
+
+    bool operator()( std::int32_t x ) const  { return integral(x); }
+    bool operator()( std::uint32_t x ) const { return integral(x); }
+    bool operator()( std::int64_t x ) const  { return integral(x); }
+    bool operator()( std::uint64_t x ) const { return integral(x); }
+
+    bool operator()( double x ) const
+    {
+      if(assign(m_translator.m_float_members, static_cast<float>(x))) return true;
+
+      // Doubles in range of an int can also populate int members
+      return x >= static_cast<double>(std::numeric_limits<int>::min()) &&
+             x <= static_cast<double>(std::numeric_limits<int>::max()) &&
+             assign(m_translator.m_int_members, static_cast<int>(x));
+    }
+
+    bool operator()( std::string_view x ) const
+    {
+      return assign(m_translator.m_string_members, x, x.size());
+    }
+
+    bool operator()( DataValue::array_tag, const DataValue& ) const
+    {
+      return false;
+    }
+
+    bool operator()( DataValue::object_tag, const DataValue& ) const
+    {
+      return false;
+    }
+
+  private:
+
+    /// \brief Assigns an integer to an int member, or else a float member
+    template<typename Integer>
+    bool integral( Integer x ) const
+    {
+      return assign(m_translator.m_int_members, static_cast<int>(x)) ||
+             assign(m_translator.m_float_members, static_cast<float>(x));
+    }
+
+    /// \brief Assigns \p x to the member bound to the key in \p members
+    template<typename Map, typename U>
+    bool assign( const Map& members, const U& x, std::size_t bytes = sizeof(U) ) const
+    {
+      auto it = members.find(m_key);
+      if( it == members.end() ) return false;
+
+      m_object.*(it->second) = x;
+      m_sample.matched(bytes);
+      if(m_assigned){
+        m_assigned->push_back(assignment(&copy_member<typename Map::mapped_type>, &it->second));
+      }
+      return true;
+    }
+
+    const this_type&   m_translator;
+    value_type&        m_object;
+    key_handle         m_key;
+    sample_type&       m_sample;
+    assignment_list*   m_assigned; ///< where assigned members are recorded, if anywhere
+  };
+
+  template<class T>
+  inline DataTranslator<T>::DataTranslator()
     : m_members(0)
   {
 
@@ -26,8 +121,12 @@ namespace serial{
   inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
                                                            bool_member member )
   {
+    const key_handle key = KeyTable::intern(str);
+
     ++m_members;
-    m_bool_members[ str ] = member;
+    m_counters.bind(str);
+    m_bool_members[ key ] = member;
+    m_layout.add(key, field_kind::boolean);
     return (*this);
   }
 
@@ -35,8 +134,12 @@ namespace serial{
   inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
                                                            int_member member )
   {
+    const key_handle key = KeyTable::intern(str);
+
     ++m_members;
-    m_int_members[ str ] = member;
+    m_counters.bind(str);
+    m_int_members[ key ] = member;
+    m_layout.add(key, field_kind::integer);
     return (*this);
   }
 
@@ -44,8 +147,12 @@ namespace serial{
   inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
                                                            float_member member )
   {
+    const key_handle key = KeyTable::intern(str);
+
     ++m_members;
-    m_float_members[ str ] = member;
+    m_counters.bind(str);
+    m_float_members[ key ] = member;
+    m_layout.add(key, field_kind::floating);
     return (*this);
   }
 
@@ -53,8 +160,12 @@ namespace serial{
   inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
                                                            string_member member )
   {
+    const key_handle key = KeyTable::intern(str);
+
     ++m_members;
-    m_string_members[ str ] = member;
+    m_counters.bind(str);
+    m_string_members[ key ] = member;
+    m_layout.add(key, field_kind::string);
     return (*this);
   }
 
@@ -65,9 +176,13 @@ namespace serial{
                                                            bool_array member,
                                                            size_type size )
   {
+    const key_handle key = KeyTable::intern(str);
+
     ++m_members;
+    m_counters.bind(str);
     bool_array_entry entry(member,size);
-    m_bool_array_members[ str ] = entry;
+    m_bool_array_members[ key ] = entry;
+    m_layout.add(key, field_kind::bool_array);
     return (*this);
   }
 
@@ -76,9 +191,13 @@ namespace serial{
                                                            int_array member,
                                                            size_type size )
   {
+    const key_handle key = KeyTable::intern(str);
+
     ++m_members;
+    m_counters.bind(str);
     int_array_entry entry(member,size);
-    m_int_array_members[ str ] = entry;
+    m_int_array_members[ key ] = entry;
+    m_layout.add(key, field_kind::int_array);
     return (*this);
   }
 
@@ -87,20 +206,82 @@ namespace serial{
                                                            float_array member,
                                                            size_type size )
   {
+    const key_handle key = KeyTable::intern(str);
+
     ++m_members;
+    m_counters.bind(str);
     float_array_entry entry(member,size);
-    m_float_array_members[ str ] = entry;
+    m_float_array_members[ key ] = entry;
+    m_layout.add(key, field_kind::float_array);
     return (*this);
   }
 
   template<class T>
   inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
                                                            string_array member,
-                                                           size_type size ){
-      ++m_members;
-      string_array_entry entry(member,size);
-      m_string_array_members[ str ] = entry;
-      return (*this);
+                                                           size_type size )
+  {
+    const key_handle key = KeyTable::intern(str);
+
+    ++m_members;
+    m_counters.bind(str);
+    string_array_entry entry(member,size);
+    m_string_array_members[ key ] = entry;
+    m_layout.add(key, field_kind::string_array);
+    return (*this);
+  }
+
+  //---------------------------------------------------------------------------
+
+  template<class T>
+  inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
+                                                           double_member member )
+  {
+    return add_member(str, member, double_converter());
+  }
+
+  template<class T>
+  inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
+                                                           int64_member member )
+  {
+    return add_member(str, member, int64_converter());
+  }
+
+  template<class T>
+  inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
+                                                           uint64_member member )
+  {
+    return add_member(str, member, uint64_converter());
+  }
+
+  template<class T>
+  template<typename U, typename Converter, typename>
+  inline DataTranslator<T>& DataTranslator<T>::add_member( const std::string& str,
+                                                           U value_type::*member,
+                                                           Converter converter )
+  {
+    const key_handle key = KeyTable::intern(str);
+
+    ++m_members;
+    m_counters.bind(str);
+
+    // The converter is captured by value so that its call is resolved here,
+    // leaving only the call through the std::function at translation time
+    m_converter_members[ key ] = converter_entry{
+      [member, converter]( const DataValue& node, value_type& object ) -> bool {
+        if constexpr (std::is_same_v<std::invoke_result_t<const Converter&,const DataValue&,U&>, bool>){
+          return converter(node, object.*member);
+        }else{
+          converter(node, object.*member);
+          return true;
+        }
+      },
+      [member]( value_type& object, const value_type& source ){
+        object.*member = source.*member;
+      },
+      sizeof(U)
+    };
+    return (*this);
   }
 
   //---------------------------------------------------------------------------
@@ -112,57 +293,26 @@ namespace serial{
   DataTranslator<T>::translate( value_type& object,
                                 const DataValue* data ) const
   {
-    if( !data->is_object() ) return 0;
-
-    size_type entries_matched = 0;
+    return translate_members(object, data, nullptr);
+  }
 
-    //-------------------------------------------------------------------------
-    // Match up Scalar members
-    //-------------------------------------------------------------------------
-
-    typedef typename bool_member_map::const_iterator   bm_iterator;
-    typedef typename int_member_map::const_iterator    im_iterator;
-    typedef typename float_member_map::const_iterator  fm_iterator;
-    typedef typename string_member_map::const_iterator sm_iterator;
-
-    typedef typename bool_member_map::const_iterator   bm_iterator;
-    typedef typename int_member_map::const_iterator    im_iterator;
-    typedef typename float_member_map::const_iterator  fm_iterator;
-    typedef typename string_member_map::const_iterator sm_iterator;
-
-    data->for_each_object([&](const std::string& key, const DataValue& node){
-      if( node.is_integral() ){
-        im_iterator im_iter = m_int_members.find(key);
-        if( im_iter != m_int_members.end() ){
-          int_member im_ptr = im_iter->second;
-          object.*im_ptr = node.as_int();
-          ++entries_matched;
-        }
-      }else if( node.is_bool() ){
-        bm_iterator bm_iter = m_bool_members.find(key);
-        if( bm_iter != m_bool_members.end() ){
-          bool_member  bm_ptr = bm_iter->second;
-          object.*bm_ptr = node.as_bool();
-          ++entries_matched;
-        }
-      }else if( node.is_double() ){
-        fm_iterator fm_iter = m_float_members.find(key);
-        if( fm_iter != m_float_members.end() ){
-          float_member fm_ptr = fm_iter->second;
-          object.*fm_ptr = (float) node.as_double();
-          ++entries_matched;
-        }
-      }else if( node.is_string() ){
-        sm_iterator sm_iter = m_string_members.find(key);
-        if( sm_iter != m_string_members.end() ){
-          string_member sm_ptr = sm_iter->second;
-          object.*sm_ptr = node.as_string();
-          ++entries_matched;
-        }
-      }
-    });
+  template<class T>
+  inline typename DataTranslator<T>::size_type
+  DataTranslator<T>::translate( value_type& object,
+                                const DataValue* data,
+                                assignment_list& assigned ) const
+  {
+    return translate_members(object, data, &assigned);
+  }
 
-    return entries_matched;
+  template<class T>
+  inline void DataTranslator<T>::assign( value_type& object,
+                                         const value_type& source,
+                                         const assignment_list& assigned ) const
+  {
+    for(const auto& x : assigned){
+      x.m_copy(object, source, x.m_binding);
+    }
   }
 
   template<class T>
@@ -183,4 +333,197 @@ namespace serial{
     return result;
   }
 
+  //---------------------------------------------------------------------------
+
+  template<class T>
+  inline typename DataTranslator<T>::size_type
+  DataTranslator<T>::translate_members( value_type& object,
+                                        const DataValue* data,
+                                        assignment_list* assigned ) const
+  {
+    if( !data->is_object() ) return 0;
+
+    size_type entries_matched = 0;
+
+    sample_type sample;
+
+    data->for_each_member([&](key_handle key, const DataValue& node){
+      if( node.visit(member_visitor(*this, object, key, sample, assigned)) ||
+          convert(object, key, node, sample, assigned) ){
+        ++entries_matched;
+      }else{
+        sample.missed([&]{ return m_counters.is_bound(key.name()); });
+      }
+    });
+
+    m_counters.record(sample);
+
+    return entries_matched;
+  }
+
+  template<class T>
+  inline bool DataTranslator<T>::convert( value_type& object,
+                                          key_handle key,
+                                          const DataValue& node,
+                                          sample_type& sample,
+                                          assignment_list* assigned ) const
+  {
+    if( m_converter_members.empty() ) return false;
+
+    auto it = m_converter_members.find(key);
+    if( it == m_converter_members.end() || !it->second.convert(node, object) ){
+      return false;
+    }
+    sample.matched(it->second.bytes);
+    if(assigned){
+      assigned->push_back(assignment(&copy_converted, &it->second));
+    }
+    return true;
+  }
+
+  template<class T>
+  template<typename Member>
+  inline void DataTranslator<T>::copy_member( value_type& object,
+                                              const value_type& source,
+                                              const void* binding )
+  {
+    const Member member = *static_cast<const Member*>(binding);
+    object.*member = source.*member;
+  }
+
+  template<class T>
+  inline void DataTranslator<T>::copy_converted( value_type& object,
+                                                 const value_type& source,
+                                                 const void* binding )
+  {
+    static_cast<const converter_entry*>(binding)->copy(object, source);
+  }
+
+  //---------------------------------------------------------------------------
+  // Fixed Layout
+  //---------------------------------------------------------------------------
+
+  template<class T>
+  inline const FixedLayout& DataTranslator<T>::layout() const noexcept
+  {
+    return m_layout;
+  }
+
+  template<class T>
+  inline std::vector<char> DataTranslator<T>::encode( const value_type& object ) const
+  {
+    FixedWriter writer(m_layout);
+
+    for_each_field(m_bool_members, field_kind::boolean, [&]( const field_layout& field, bool_member member ){
+      writer.set(field, object.*member);
+    });
+    for_each_field(m_int_members, field_kind::integer, [&]( const field_layout& field, int_member member ){
+      writer.set(field, object.*member);
+    });
+    for_each_field(m_float_members, field_kind::floating, [&]( const field_layout& field, float_member member ){
+      writer.set(field, object.*member);
+    });
+    for_each_field(m_string_members, field_kind::string, [&]( const field_layout& field, string_member member ){
+      writer.set(field, std::string_view(object.*member));
+    });
+
+    // Arrays are written at their bound size
+    const auto write_array = [&]( const field_layout& field, const auto& entry ){
+      writer.set(field, object.*(entry.first), static_cast<std::size_t>(std::max(entry.second, 0)));
+    };
+    for_each_field(m_bool_array_members, field_kind::bool_array, write_array);
+    for_each_field(m_int_array_members, field_kind::int_array, write_array);
+    for_each_field(m_float_array_members, field_kind::float_array, write_array);
+    for_each_field(m_string_array_members, field_kind::string_array, write_array);
+
+    if(writer.dropped()) return std::vector<char>();
+    return writer.finish();
+  }
+
+  template<class T>
+  inline typename DataTranslator<T>::size_type
+  DataTranslator<T>::decode( value_type& object, const FixedView& view ) const
+  {
+    size_type entries_matched = 0;
+
+    for_each_field(m_bool_members, field_kind::boolean, [&]( const field_layout& field, bool_member member ){
+      if(!view.has_field(field.id)) return;
+      object.*member = view.get_bool(field.id);
+      ++entries_matched;
+    });
+    for_each_field(m_int_members, field_kind::integer, [&]( const field_layout& field, int_member member ){
+      if(!view.has_field(field.id)) return;
+      object.*member = view.get_int(field.id);
+      ++entries_matched;
+    });
+    for_each_field(m_float_members, field_kind::floating, [&]( const field_layout& field, float_member member ){
+      if(!view.has_field(field.id)) return;
+      object.*member = view.get_float(field.id);
+      ++entries_matched;
+    });
+    for_each_field(m_string_members, field_kind::string, [&]( const field_layout& field, string_member member ){
+      if(!view.has_field(field.id)) return;
+      object.*member = std::string(view.get_string(field.id));
+      ++entries_matched;
+    });
+
+    // Copies at most the bound size of elements into an array member
+    const auto read_array = [&]( const field_layout& field, const auto& entry, const auto& get ){
+      if(!view.has_field(field.id) || !(object.*(entry.first))) return;
+
+      const std::size_t count = std::min(view.get_size(field.id),
+                                         static_cast<std::size_t>(std::max(entry.second, 0)));
+      for(std::size_t i = 0; i < count; ++i){
+        (object.*(entry.first))[i] = get(field.id, i);
+      }
+      ++entries_matched;
+    };
+    for_each_field(m_bool_array_members, field_kind::bool_array, [&]( const field_layout& field, const bool_array_entry& entry ){
+      read_array(field, entry, [&]( std::size_t id, std::size_t i ){ return view.get_bool_at(id, i); });
+    });
+    for_each_field(m_int_array_members, field_kind::int_array, [&]( const field_layout& field, const int_array_entry& entry ){
+      read_array(field, entry, [&]( std::size_t id, std::size_t i ){ return view.get_int_at(id, i); });
+    });
+    for_each_field(m_float_array_members, field_kind::float_array, [&]( const field_layout& field, const float_array_entry& entry ){
+      read_array(field, entry, [&]( std::size_t id, std::size_t i ){ return view.get_float_at(id, i); });
+    });
+    for_each_field(m_string_array_members, field_kind::string_array, [&]( const field_layout& field, const string_array_entry& entry ){
+      read_array(field, entry, [&]( std::size_t id, std::size_t i ){ return std::string(view.get_string_at(id, i)); });
+    });
+
+    return entries_matched;
+  }
+
+  //---------------------------------------------------------------------------
+
+  template<class T>
+  template<typename Map, typename Func>
+  inline void DataTranslator<T>::for_each_field( const Map& members,
+                                                 field_kind kind,
+                                                 const Func& function ) const
+  {
+    for(const auto& x : members){
+      const field_layout* field = m_layout.find(x.first);
+      if(field && field->kind == kind){
+        function(*field, x.second);
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Instrumentation
+  //---------------------------------------------------------------------------
+
+  template<class T>
+  inline translator_statistics DataTranslator<T>::statistics() const
+  {
+    return m_counters.aggregate();
+  }
+
+  template<class T>
+  inline void DataTranslator<T>::reset_statistics()
+  {
+    m_counters.reset();
+  }
+
 } // namespace serial
@@ -0,0 +1,186 @@
+/**
+ * \file DataValueIterator.hpp
+ *
+ * Iterators over the elements of array and the members of object
+ * \c DataValues
+ *
+ */
+#ifndef SERIAL_DETAIL_DATAVALUEITERATOR_HPP_
+#define SERIAL_DETAIL_DATAVALUEITERATOR_HPP_
+
+#include "../KeyTable.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace serial{
+  namespace detail{
+
+    /// \brief Selects the const or mutable iterator of \p Container
+    template<typename Container, bool Const>
+    using container_iterator = typename std::conditional<Const,
+      typename Container::const_iterator,
+      typename Container::iterator
+    >::type;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Random-access iterator over the elements of an array, yielding
+    ///        \p Value references (\c DataValue or \c const \c DataValue)
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename Value>
+    class element_iterator final{
+
+      using node_type = typename std::remove_const<Value>::type;
+      using base_type = container_iterator<std::vector<std::unique_ptr<node_type>>,
+                                           std::is_const<Value>::value>;
+
+    public:
+
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type        = node_type;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = Value*;
+      using reference         = Value&;
+
+      element_iterator() = default;
+
+      explicit element_iterator( base_type it ) : m_it(it){}
+
+      /// \brief Converts a mutable iterator to a const iterator
+      template<typename U, typename = typename std::enable_if<
+        std::is_const<Value>::value && std::is_same<U,node_type>::value
+      >::type>
+      element_iterator( const element_iterator<U>& other ) : m_it(other.base()){}
+
+      base_type base() const { return m_it; }
+
+      reference operator*() const { return **m_it; }
+      pointer operator->() const { return m_it->get(); }
+      reference operator[]( difference_type n ) const { return *m_it[n]; }
+
+      element_iterator& operator++(){ ++m_it; return (*this); }
+      element_iterator& operator--(){ --m_it; return (*this); }
+      element_iterator operator++(int){ return element_iterator(m_it++); }
+      element_iterator operator--(int){ return element_iterator(m_it--); }
+
+      element_iterator& operator+=( difference_type n ){ m_it += n; return (*this); }
+      element_iterator& operator-=( difference_type n ){ m_it -= n; return (*this); }
+
+      friend element_iterator operator+( element_iterator it, difference_type n ){ return it += n; }
+      friend element_iterator operator+( difference_type n, element_iterator it ){ return it += n; }
+      friend element_iterator operator-( element_iterator it, difference_type n ){ return it -= n; }
+      friend difference_type operator-( const element_iterator& lhs, const element_iterator& rhs ){ return lhs.m_it - rhs.m_it; }
+
+      friend bool operator==( const element_iterator& lhs, const element_iterator& rhs ){ return lhs.m_it == rhs.m_it; }
+      friend bool operator!=( const element_iterator& lhs, const element_iterator& rhs ){ return lhs.m_it != rhs.m_it; }
+      friend bool operator< ( const element_iterator& lhs, const element_iterator& rhs ){ return lhs.m_it <  rhs.m_it; }
+      friend bool operator> ( const element_iterator& lhs, const element_iterator& rhs ){ return lhs.m_it >  rhs.m_it; }
+      friend bool operator<=( const element_iterator& lhs, const element_iterator& rhs ){ return lhs.m_it <= rhs.m_it; }
+      friend bool operator>=( const element_iterator& lhs, const element_iterator& rhs ){ return lhs.m_it >= rhs.m_it; }
+
+    private:
+
+      base_type m_it = base_type();
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A member of an object, as yielded by \c member_iterator
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename Value>
+    struct member_reference
+    {
+      key_handle key;   ///< the interned name of the member
+      Value&     value; ///< the value of the member
+
+      /// \brief Gets the name of the member
+      const std::string& name() const { return key.name(); }
+
+      /// \brief Supports \c operator-> on iterators yielding proxies
+      const member_reference* operator->() const { return this; }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Iterator over the members of an object, in key order, yielding
+    ///        \c member_reference proxies
+    ///
+    /// Since dereferencing yields a proxy by value rather than a reference,
+    /// this is only an input iterator, although it can also be decremented
+    /// and traversed more than once. Algorithms requiring forward iterators,
+    /// including every algorithm taking an execution policy, cannot be used
+    /// on it; \c parallel_for_each_object traverses members in parallel.
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename Value>
+    class member_iterator final{
+
+      using node_type = typename std::remove_const<Value>::type;
+      using base_type = container_iterator<std::map<key_handle,std::unique_ptr<node_type>>,
+                                           std::is_const<Value>::value>;
+
+    public:
+
+      using iterator_category = std::input_iterator_tag;
+      using value_type        = member_reference<Value>;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = member_reference<Value>;
+      using reference         = member_reference<Value>;
+
+      member_iterator() = default;
+
+      explicit member_iterator( base_type it ) : m_it(it){}
+
+      /// \brief Converts a mutable iterator to a const iterator
+      template<typename U, typename = typename std::enable_if<
+        std::is_const<Value>::value && std::is_same<U,node_type>::value
+      >::type>
+      member_iterator( const member_iterator<U>& other ) : m_it(other.base()){}
+
+      base_type base() const { return m_it; }
+
+      reference operator*() const { return reference{m_it->first, *m_it->second}; }
+      pointer operator->() const { return **this; }
+
+      member_iterator& operator++(){ ++m_it; return (*this); }
+      member_iterator& operator--(){ --m_it; return (*this); }
+      member_iterator operator++(int){ return member_iterator(m_it++); }
+      member_iterator operator--(int){ return member_iterator(m_it--); }
+
+      friend bool operator==( const member_iterator& lhs, const member_iterator& rhs ){ return lhs.m_it == rhs.m_it; }
+      friend bool operator!=( const member_iterator& lhs, const member_iterator& rhs ){ return lhs.m_it != rhs.m_it; }
+
+    private:
+
+      base_type m_it = base_type();
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A pair of iterators usable in range-based for loops
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename Iterator>
+    class iterator_range final{
+
+    public:
+
+      iterator_range() = default;
+
+      iterator_range( Iterator first, Iterator last ) : m_first(first), m_last(last){}
+
+      Iterator begin() const { return m_first; }
+      Iterator end() const { return m_last; }
+
+      bool empty() const { return m_first == m_last; }
+
+    private:
+
+      Iterator m_first;
+      Iterator m_last;
+    };
+
+  } // namespace detail
+} // namespace serial
+
+#endif /* SERIAL_DETAIL_DATAVALUEITERATOR_HPP_ */
@@ -0,0 +1,130 @@
+/**
+ * \file SharedStorage.hpp
+ *
+ * An atomically reference counted pointer to the storage of an array or
+ * object, shared by copies of a \c DataValue until one of them writes
+ *
+ */
+#ifndef SERIAL_DETAIL_SHAREDSTORAGE_HPP_
+#define SERIAL_DETAIL_SHAREDSTORAGE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace serial{
+  namespace detail{
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Owns a \c T together with the number of its owners
+    ///
+    /// Unlike \c std::shared_ptr::use_count, which is a relaxed load, \c unique
+    /// synchronizes with every owner that has released the storage: owners
+    /// release with \c acq_rel, and \c unique loads with \c acquire, so once
+    /// \c unique returns \c true, every read made by a former owner happens
+    /// before any write the sole owner then makes in place.
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    class shared_storage final{
+
+    public:
+
+      /// \brief Constructs storage holding a value-initialized \c T
+      static shared_storage make()
+      {
+        return shared_storage(new block());
+      }
+
+      /// \brief Constructs a pointer to no storage
+      shared_storage() noexcept
+        : m_block(nullptr)
+      {
+
+      }
+
+      shared_storage( const shared_storage& other ) noexcept
+        : m_block(other.m_block)
+      {
+        if(m_block) m_block->owners.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      shared_storage( shared_storage&& other ) noexcept
+        : m_block(other.m_block)
+      {
+        other.m_block = nullptr;
+      }
+
+      ~shared_storage()
+      {
+        release();
+      }
+
+      shared_storage& operator=( const shared_storage& other ) noexcept
+      {
+        shared_storage(other).swap(*this);
+        return (*this);
+      }
+
+      shared_storage& operator=( shared_storage&& other ) noexcept
+      {
+        shared_storage(std::move(other)).swap(*this);
+        return (*this);
+      }
+
+      void swap( shared_storage& other ) noexcept
+      {
+        std::swap(m_block, other.m_block);
+      }
+
+      /// \brief Checks whether this is the only owner of the storage
+      ///
+      /// \return \c true if no other owner can read the storage
+      bool unique() const noexcept
+      {
+        return m_block && m_block->owners.load(std::memory_order_acquire) == 1;
+      }
+
+      T& operator*() const noexcept { return m_block->value; }
+      T* operator->() const noexcept { return &m_block->value; }
+
+      friend bool operator==( const shared_storage& lhs, const shared_storage& rhs ) noexcept
+      {
+        return lhs.m_block == rhs.m_block;
+      }
+
+      friend bool operator!=( const shared_storage& lhs, const shared_storage& rhs ) noexcept
+      {
+        return lhs.m_block != rhs.m_block;
+      }
+
+    private:
+
+      struct block
+      {
+        block() : owners(1), value(){}
+
+        std::atomic<std::size_t> owners;
+        T                        value;
+      };
+
+      explicit shared_storage( block* b ) noexcept
+        : m_block(b)
+      {
+
+      }
+
+      void release() noexcept
+      {
+        if(m_block && m_block->owners.fetch_sub(1, std::memory_order_acq_rel) == 1){
+          delete m_block;
+        }
+        m_block = nullptr;
+      }
+
+      block* m_block;
+    };
+
+  } // namespace detail
+} // namespace serial
+
+#endif /* SERIAL_DETAIL_SHAREDSTORAGE_HPP_ */
@@ -0,0 +1,117 @@
+/**
+ * \file ArrayBuilder.cpp
+ *
+ * Implementation of \c ArrayBuilder, which builds one array from
+ * per-thread shards
+ */
+#include <ArrayBuilder.hpp>
+
+#include <atomic>
+#include <utility>
+
+namespace serial{
+
+  //--------------------------------------------------------------------------
+  // Static Members
+  //--------------------------------------------------------------------------
+
+  /// The next generation to hand out; 0 is never handed out
+  static std::atomic<std::uint64_t> s_generation(1);
+
+  /// The generation and shard of the last builder the calling thread
+  /// appended to
+  static thread_local std::uint64_t t_generation = 0;
+  static thread_local DataValue*    t_shard      = nullptr;
+
+  //--------------------------------------------------------------------------
+  // Constructor
+  //--------------------------------------------------------------------------
+
+  ArrayBuilder::ArrayBuilder()
+    : m_generation(s_generation.fetch_add(1, std::memory_order_relaxed))
+  {
+
+  }
+
+  //--------------------------------------------------------------------------
+  // Modifiers
+  //--------------------------------------------------------------------------
+
+  void ArrayBuilder::add_member( const DataValue& value )
+  {
+    local().add_member(value);
+  }
+
+  void ArrayBuilder::add_member( DataValue&& value )
+  {
+    local().add_member(std::move(value));
+  }
+
+  void ArrayBuilder::reserve( size_type n )
+  {
+    DataValue& values = local();
+    values.reserve(values.size() + n);
+  }
+
+  DataValue ArrayBuilder::finish()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Cached shards of the previous generation are never used again
+    m_generation = s_generation.fetch_add(1, std::memory_order_relaxed);
+    m_threads.clear();
+
+    DataValue result(DataValue::type_array);
+    if(m_shards.empty()) return result;
+
+    size_type total = 0;
+    for(const auto& x : m_shards){
+      total += x->values.size();
+    }
+
+    // The first shard becomes the array; the others are moved onto its end
+    result = std::move(m_shards.front()->values);
+    result.reserve(total);
+    for(std::size_t i = 1; i < m_shards.size(); ++i){
+      result.splice(result.size(), m_shards[i]->values);
+    }
+    m_shards.clear();
+    return result;
+  }
+
+  //--------------------------------------------------------------------------
+  // Observers
+  //--------------------------------------------------------------------------
+
+  ArrayBuilder::size_type ArrayBuilder::shards() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_shards.size();
+  }
+
+  //--------------------------------------------------------------------------
+  // Private Member Functions
+  //--------------------------------------------------------------------------
+
+  DataValue& ArrayBuilder::local()
+  {
+    if(t_generation == m_generation){
+      return *t_shard;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // A thread that appended to another builder in between has a shard here
+    shard*& entry = m_threads[std::this_thread::get_id()];
+    if(!entry){
+      m_shards.emplace_back(new shard{DataValue(DataValue::type_array)});
+      entry = m_shards.back().get();
+    }
+
+    t_generation = m_generation;
+    t_shard      = &entry->values;
+    return *t_shard;
+  }
+
+} // namespace serial
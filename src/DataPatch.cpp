@@ -0,0 +1,415 @@
+/**
+ * \file DataPatch.cpp
+ *
+ * Implementation of \c diff and \c apply_patch, which compute and apply
+ * the edits between two \c DataValue trees
+ */
+#include <DataPatch.hpp>
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+namespace serial{
+
+  //--------------------------------------------------------------------------
+  // Private Types
+  //--------------------------------------------------------------------------
+
+  using size_type    = DataValue::size_type;
+  using pointer_path = std::vector<std::string>;
+
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  static DataValue make_string( const std::string& str )
+  {
+    DataValue result;
+    result.set_string(str);
+    return result;
+  }
+
+  /// \brief Appends \p token to the JSON Pointer \p path, escaping it
+  static void append_token( std::string& path, const std::string& token )
+  {
+    path += '/';
+    for(char c : token){
+      switch(c){
+      case '~': path += "~0"; break;
+      case '/': path += "~1"; break;
+      default:  path += c;    break;
+      }
+    }
+  }
+
+  static void append_token( std::string& path, size_type index )
+  {
+    append_token(path, std::to_string(index));
+  }
+
+  static void add_operation( DataValue& patch,
+                             const char* op,
+                             const std::string& path,
+                             const DataValue* value )
+  {
+    DataValue entry(DataValue::type_object);
+    entry.add_member("op", make_string(op));
+    entry.add_member("path", make_string(path));
+    if(value){
+      entry.add_member("value", *value);
+    }
+    patch.add_member(entry);
+  }
+
+  //--------------------------------------------------------------------------
+  // Diff
+  //--------------------------------------------------------------------------
+
+  /// \brief A pair of containers being diffed. Objects advance 'it' over
+  ///        the members of 'from'; arrays advance 'index' over the common
+  ///        elements, then remove and add the rest
+  struct diff_frame
+  {
+    const DataValue*                 from;
+    const DataValue*                 to;
+    size_type                        length;   ///< the length of their path
+    DataValue::const_object_iterator it;
+    size_type                        index;
+    size_type                        common;   ///< one past the last common element
+    size_type                        from_end; ///< one past the last element to remove
+    size_type                        to_end;   ///< one past the last element to add
+  };
+
+  /// \brief Starts diffing the containers \p from and \p to, at a path of
+  ///        \p length characters
+  static diff_frame enter( const DataValue& from, const DataValue& to, size_type length )
+  {
+    diff_frame frame{&from, &to, length, DataValue::const_object_iterator(), 0, 0, 0, 0};
+    if(from.is_object()){
+      frame.it = from.members().begin();
+      return frame;
+    }
+
+    const size_type from_size = from.size();
+    const size_type to_size   = to.size();
+
+    // Trim the common prefix and suffix when the sizes differ, so that an
+    // insertion or removal in the middle does not replace every later element
+    size_type prefix = 0;
+    size_type suffix = 0;
+    if(from_size != to_size){
+      const size_type count = std::min(from_size, to_size);
+      while(prefix < count && from.at(prefix).equals(to.at(prefix))){
+        ++prefix;
+      }
+      while(suffix < count - prefix &&
+            from.at(from_size - suffix - 1).equals(to.at(to_size - suffix - 1))){
+        ++suffix;
+      }
+    }
+
+    frame.from_end = from_size - suffix;
+    frame.to_end   = to_size - suffix;
+    frame.index    = prefix;
+    frame.common   = prefix + std::min(frame.from_end - prefix, frame.to_end - prefix);
+    return frame;
+  }
+
+  DataValue diff( const DataValue& from, const DataValue& to )
+  {
+    DataValue   patch(DataValue::type_array);
+    std::string path;
+
+    std::vector<diff_frame> stack;
+
+    // Diffs two nodes at 'path', queueing them if both are the same kind
+    // of container and do not share storage
+    const auto visit = [&]( const DataValue& lhs, const DataValue& rhs ){
+      if(lhs.shares_with(rhs)) return;
+
+      if(lhs.type() == rhs.type() && (lhs.is_object() || lhs.is_array())){
+        stack.push_back(enter(lhs, rhs, path.size()));
+      }else if(!lhs.equals(rhs)){
+        add_operation(patch, "replace", path, &rhs);
+      }
+    };
+
+    // Each pass handles one child of the top container; operations are
+    // emitted in the same order as a recursive walk would
+    visit(from, to);
+    while(!stack.empty()){
+      diff_frame& top = stack.back();
+      path.resize(top.length);
+
+      if(top.from->is_object()){
+        if(top.it != top.from->members().end()){
+          const auto member = *top.it;
+          ++top.it;
+
+          append_token(path, member.key.name());
+          const DataValue* other = top.to->find_member(member.key);
+          if(other){
+            visit(member.value, *other);
+          }else{
+            add_operation(patch, "remove", path, nullptr);
+          }
+          continue;
+        }
+
+        for(const auto& x : top.to->members()){
+          if(top.from->has_member(x.key)) continue;
+
+          path.resize(top.length);
+          append_token(path, x.key.name());
+          add_operation(patch, "add", path, &x.value);
+        }
+      }else{
+        if(top.index < top.common){
+          const size_type i = top.index++;
+
+          append_token(path, i);
+          visit(top.from->at(i), top.to->at(i));
+          continue;
+        }
+
+        // Remove from the back so that earlier indices stay valid
+        for(size_type i = top.from_end; i > top.common; --i){
+          path.resize(top.length);
+          append_token(path, i - 1);
+          add_operation(patch, "remove", path, nullptr);
+        }
+
+        for(size_type i = top.common; i < top.to_end; ++i){
+          path.resize(top.length);
+          append_token(path, i);
+          add_operation(patch, "add", path, &top.to->at(i));
+        }
+      }
+      stack.pop_back();
+    }
+    return patch;
+  }
+
+  //--------------------------------------------------------------------------
+  // Patch
+  //--------------------------------------------------------------------------
+
+  /// \brief Splits a JSON Pointer into its unescaped reference tokens
+  static bool parse_pointer( const std::string& pointer, pointer_path& tokens )
+  {
+    tokens.clear();
+    if(pointer.empty()) return true;
+    if(pointer[0] != '/') return false;
+
+    for(size_type i = 0; i < pointer.size(); ++i){
+      const char c = pointer[i];
+      if(c == '/'){
+        tokens.emplace_back();
+      }else if(c == '~'){
+        if(++i == pointer.size()) return false;
+
+        switch(pointer[i]){
+        case '0': tokens.back() += '~'; break;
+        case '1': tokens.back() += '/'; break;
+        default:  return false;
+        }
+      }else{
+        tokens.back() += c;
+      }
+    }
+    return true;
+  }
+
+  /// \brief Parses an array index token, rejecting leading zeros
+  static bool parse_index( const std::string& token, size_type& index )
+  {
+    if(token.empty() || (token.size() > 1 && token[0] == '0')) return false;
+
+    index = 0;
+    for(char c : token){
+      if(c < '0' || c > '9') return false;
+
+      const size_type digit = static_cast<size_type>(c - '0');
+      if(index > (std::numeric_limits<size_type>::max() - digit) / 10) return false;
+      index = index * 10 + digit;
+    }
+    return true;
+  }
+
+  /// \brief Finds the first \p count tokens of \p tokens under \p root
+  ///
+  /// \note Walking a non-const tree clones any shared levels on the way, so
+  ///       this is only used on the path of a modification
+  template<typename Value>
+  static Value* find_value( Value& root, const pointer_path& tokens, size_type count )
+  {
+    Value* node = &root;
+    for(size_type i = 0; i < count; ++i){
+      const std::string& token = tokens[i];
+      if(node->is_object()){
+        const key_handle key = KeyTable::find(token);
+        if(!node->has_member(key)) return nullptr;
+        node = &node->at(key);
+      }else if(node->is_array()){
+        size_type index;
+        if(!parse_index(token, index) || index >= node->size()) return nullptr;
+        node = &node->at(index);
+      }else{
+        return nullptr;
+      }
+    }
+    return node;
+  }
+
+  static bool add_value( DataValue& root, const pointer_path& tokens, DataValue value )
+  {
+    if(tokens.empty()){
+      root = std::move(value);
+      return true;
+    }
+
+    DataValue* parent = find_value(root, tokens, tokens.size() - 1);
+    if(!parent) return false;
+
+    const std::string& token = tokens.back();
+    if(parent->is_object()){
+      // Patches are untrusted input, which must not grow the key table
+      // without bound
+      const key_handle key = KeyTable::try_intern(token);
+      if(!key.valid()) return false;
+
+      parent->add_member(key, std::move(value));
+      return true;
+    }
+    if(parent->is_array()){
+      if(token == "-"){
+        parent->add_member(std::move(value));
+        return true;
+      }
+
+      size_type index;
+      if(!parse_index(token, index) || index > parent->size()) return false;
+
+      // Appended, then moved into place by shifting only the later pointers
+      parent->add_member(std::move(value));
+      return parent->splice(index, *parent, parent->size() - 1);
+    }
+    return false;
+  }
+
+  /// \brief Removes the value at \p tokens from \p root into \p value,
+  ///        without copying it
+  static bool take_value( DataValue& root, const pointer_path& tokens, DataValue& value )
+  {
+    if(tokens.empty()) return false;
+
+    DataValue* parent = find_value(root, tokens, tokens.size() - 1);
+    if(!parent) return false;
+
+    const std::string& token = tokens.back();
+    if(parent->is_object()){
+      if(!parent->has_member(token)) return false;
+
+      value = parent->take_member(token);
+      return true;
+    }
+    if(parent->is_array()){
+      size_type index;
+      if(!parse_index(token, index) || index >= parent->size()) return false;
+
+      value = parent->take_member(index);
+      return true;
+    }
+    return false;
+  }
+
+  static bool apply_operation( DataValue& root, const DataValue& operation )
+  {
+    if(!operation.is_object() ||
+       !operation.has_member("op") || !operation.at("op").is_string() ||
+       !operation.has_member("path") || !operation.at("path").is_string()){
+      return false;
+    }
+
+    const std::string op = operation.at("op").as_string();
+
+    pointer_path path;
+    if(!parse_pointer(operation.at("path").as_string(), path)) return false;
+
+    if(op == "add" || op == "replace" || op == "test"){
+      if(!operation.has_member("value")) return false;
+      const DataValue& value = operation.at("value");
+
+      if(op == "add"){
+        return add_value(root, path, value);
+      }
+      if(op == "test"){
+        const DataValue& const_root = root;
+        const DataValue* current = find_value(const_root, path, path.size());
+        return current && current->equals(value);
+      }
+
+      DataValue* current = find_value(root, path, path.size());
+      if(!current) return false;
+      *current = value;
+      return true;
+    }
+
+    if(op == "remove"){
+      DataValue removed;
+      return take_value(root, path, removed);
+    }
+
+    if(op == "move" || op == "copy"){
+      if(!operation.has_member("from") || !operation.at("from").is_string()) return false;
+
+      pointer_path from;
+      if(!parse_pointer(operation.at("from").as_string(), from)) return false;
+
+      if(op == "move"){
+        // A value cannot be moved into one of its own children
+        if(from.size() < path.size() &&
+           std::equal(from.begin(), from.end(), path.begin())){
+          return false;
+        }
+
+        if(from == path){
+          const DataValue& const_root = root;
+          return find_value(const_root, from, from.size()) != nullptr;
+        }
+
+        // The moved subtree changes owner without being copied
+        DataValue value;
+        if(!take_value(root, from, value)) return false;
+        return add_value(root, path, std::move(value));
+      }
+
+      const DataValue& const_root = root;
+      const DataValue* source = find_value(const_root, from, from.size());
+      if(!source) return false;
+
+      // Copying only shares the storage of the source subtree
+      return add_value(root, path, *source);
+    }
+    return false;
+  }
+
+  bool apply_patch( DataValue& target, const DataValue& patch )
+  {
+    if(!patch.is_array()) return false;
+
+    // Patch a copy that shares storage with 'target', so that a failed patch
+    // leaves 'target' untouched without copying the tree up front
+    DataValue result = target;
+
+    for(size_type i = 0; i < patch.size(); ++i){
+      if(!apply_operation(result, patch.at(i))) return false;
+    }
+
+    target = std::move(result);
+    return true;
+  }
+
+} // namespace serial
@@ -0,0 +1,362 @@
+/**
+ * \file DataSchema.cpp
+ *
+ * Implementation of \c DataSchema validation of \c DataValue trees
+ */
+#include <DataSchema.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace serial{
+
+  //--------------------------------------------------------------------------
+  // Static Constants
+  //--------------------------------------------------------------------------
+
+  static constexpr std::uint32_t integer_mask = (1u << DataValue::type_int)   |
+                                                (1u << DataValue::type_uint)  |
+                                                (1u << DataValue::type_int64) |
+                                                (1u << DataValue::type_uint64);
+
+  static constexpr std::uint32_t number_mask  = integer_mask | (1u << DataValue::type_double);
+
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  static bool is_number( const DataValue& value )
+  {
+    return ((1u << value.type()) & number_mask) != 0;
+  }
+
+  static bool is_integer( const DataValue& value )
+  {
+    return ((1u << value.type()) & integer_mask) != 0;
+  }
+
+  /// \brief Maps a JSON Schema type name onto a mask of data types
+  static bool type_mask( const DataValue& name, std::uint32_t& mask )
+  {
+    if(!name.is_string()) return false;
+
+    const std::string str = name.as_string();
+    if(str == "null")         mask |= 1u << DataValue::type_null;
+    else if(str == "boolean") mask |= 1u << DataValue::type_bool;
+    else if(str == "integer") mask |= integer_mask;
+    else if(str == "number")  mask |= number_mask;
+    else if(str == "string")  mask |= 1u << DataValue::type_string;
+    else if(str == "array")   mask |= 1u << DataValue::type_array;
+    else if(str == "object")  mask |= 1u << DataValue::type_object;
+    else return false;
+
+    return true;
+  }
+
+  /// \brief Reads a non-negative integral keyword value
+  static bool count_value( const DataValue& value, std::uint32_t& count )
+  {
+    if(!is_integer(value) || value.as_double() < 0.0 ||
+       value.as_double() > std::numeric_limits<std::uint32_t>::max()){
+      return false;
+    }
+    count = static_cast<std::uint32_t>(value.as_uint64());
+    return true;
+  }
+
+  /// \brief Counts the UTF-8 code points of a string value
+  static DataValue::size_type code_points( const DataValue& value )
+  {
+    const char* data = value.string_data();
+    const DataValue::size_type length = value.string_length();
+
+    DataValue::size_type result = 0;
+    for(DataValue::size_type i = 0; i < length; ++i){
+      result += (static_cast<unsigned char>(data[i]) & 0xC0) != 0x80;
+    }
+    return result;
+  }
+
+  //--------------------------------------------------------------------------
+  // Constructor
+  //--------------------------------------------------------------------------
+
+  DataSchema::DataSchema()
+    : m_root(0),
+      m_program(1, instruction{op_end, 0, 0, 0.0})
+  {
+
+  }
+
+  //--------------------------------------------------------------------------
+  // Compilation
+  //--------------------------------------------------------------------------
+
+  bool DataSchema::compile( const DataValue& schema )
+  {
+    std::vector<instruction> program;
+    std::vector<key_handle>  names;
+    std::vector<DataValue>   constants;
+
+    m_program.swap(program);
+    m_names.swap(names);
+    m_constants.swap(constants);
+
+    std::uint32_t root;
+    if(compile_block(schema, root)){
+      m_root = root;
+      return true;
+    }
+
+    // Restore the previous program
+    m_program.swap(program);
+    m_names.swap(names);
+    m_constants.swap(constants);
+    return false;
+  }
+
+  DataSchema::size_type DataSchema::instructions() const noexcept
+  {
+    return m_program.size();
+  }
+
+  //--------------------------------------------------------------------------
+  // Validation
+  //--------------------------------------------------------------------------
+
+  bool DataSchema::validate( const DataValue& value ) const
+  {
+    return run(m_root, value);
+  }
+
+  //--------------------------------------------------------------------------
+  // Private Member Functions
+  //--------------------------------------------------------------------------
+
+  bool DataSchema::compile_block( const DataValue& schema, std::uint32_t& block )
+  {
+    // Nested blocks are appended to the program while this one is built, so
+    // collect this block's instructions separately and append them last
+    std::vector<instruction> code;
+
+    if(schema.is_bool()){
+      if(!schema.as_bool()){
+        code.push_back(instruction{op_type, 0, 0, 0.0});
+      }
+    }else if(!schema.is_object()){
+      return false;
+    }else{
+      // Passing over a validation keyword would accept values the schema
+      // rejects, so the ones not supported fail the compilation
+      static const char* const unsupported[] = {
+        "multipleOf", "pattern", "format", "const", "uniqueItems",
+        "contains", "minContains", "maxContains", "prefixItems",
+        "additionalItems", "unevaluatedItems", "minProperties",
+        "maxProperties", "patternProperties", "propertyNames",
+        "dependencies", "dependentRequired", "dependentSchemas",
+        "unevaluatedProperties", "allOf", "anyOf", "oneOf", "not", "if",
+        "then", "else", "$ref", "$dynamicRef",
+      };
+      for(const char* name : unsupported){
+        if(schema.has_member(name)) return false;
+      }
+
+      if(schema.has_member("type")){
+        const DataValue& type = schema.at("type");
+        std::uint32_t mask = 0;
+
+        if(type.is_array()){
+          for(size_type i = 0; i < type.size(); ++i){
+            if(!type_mask(type.at(i), mask)) return false;
+          }
+        }else if(!type_mask(type, mask)){
+          return false;
+        }
+        code.push_back(instruction{op_type, mask, 0, 0.0});
+      }
+
+      if(schema.has_member("enum")){
+        const DataValue& values = schema.at("enum");
+        if(!values.is_array()) return false;
+
+        const std::uint32_t first = static_cast<std::uint32_t>(m_constants.size());
+        for(size_type i = 0; i < values.size(); ++i){
+          m_constants.push_back(values.at(i));
+        }
+        code.push_back(instruction{op_enum, first, static_cast<std::uint32_t>(values.size()), 0.0});
+      }
+
+      static const struct { const char* name; opcode op; std::uint32_t exclusive; } bounds[] = {
+        { "minimum",          op_minimum, 0 },
+        { "exclusiveMinimum", op_minimum, 1 },
+        { "maximum",          op_maximum, 0 },
+        { "exclusiveMaximum", op_maximum, 1 },
+      };
+      for(const auto& bound : bounds){
+        if(!schema.has_member(bound.name)) continue;
+
+        const DataValue& limit = schema.at(bound.name);
+        if(!is_number(limit)) return false;
+        code.push_back(instruction{bound.op, 0, bound.exclusive, limit.as_double()});
+      }
+
+      static const struct { const char* name; opcode op; } counts[] = {
+        { "minLength", op_min_length },
+        { "maxLength", op_max_length },
+        { "minItems",  op_min_items  },
+        { "maxItems",  op_max_items  },
+      };
+      for(const auto& count : counts){
+        if(!schema.has_member(count.name)) continue;
+
+        std::uint32_t n;
+        if(!count_value(schema.at(count.name), n)) return false;
+        code.push_back(instruction{count.op, n, 0, 0.0});
+      }
+
+      if(schema.has_member("items")){
+        std::uint32_t items;
+        if(!compile_block(schema.at("items"), items)) return false;
+        code.push_back(instruction{op_items, items, 0, 0.0});
+      }
+
+      if(schema.has_member("required")){
+        const DataValue& required = schema.at("required");
+        if(!required.is_array()) return false;
+
+        for(size_type i = 0; i < required.size(); ++i){
+          if(!required.at(i).is_string()) return false;
+
+          m_names.push_back(KeyTable::intern(required.at(i).as_string()));
+          code.push_back(instruction{op_required, static_cast<std::uint32_t>(m_names.size() - 1), 0, 0.0});
+        }
+      }
+
+      std::vector<key_handle> declared;
+      if(schema.has_member("properties")){
+        const DataValue& properties = schema.at("properties");
+        if(!properties.is_object()) return false;
+
+        bool result = true;
+        properties.for_each_member([&](key_handle name, const DataValue& property){
+          std::uint32_t property_block;
+          if(!result || !compile_block(property, property_block)){
+            result = false;
+            return;
+          }
+          m_names.push_back(name);
+          declared.push_back(name);
+          code.push_back(instruction{op_property, static_cast<std::uint32_t>(m_names.size() - 1), property_block, 0.0});
+        });
+        if(!result) return false;
+      }
+
+      if(schema.has_member("additionalProperties")){
+        const DataValue& additional = schema.at("additionalProperties");
+        if(!additional.is_bool()) return false;
+
+        if(!additional.as_bool()){
+          std::sort(declared.begin(), declared.end());
+
+          const std::uint32_t first = static_cast<std::uint32_t>(m_names.size());
+          m_names.insert(m_names.end(), declared.begin(), declared.end());
+          code.push_back(instruction{op_closed_properties, first, static_cast<std::uint32_t>(declared.size()), 0.0});
+        }
+      }
+    }
+
+    code.push_back(instruction{op_end, 0, 0, 0.0});
+
+    block = static_cast<std::uint32_t>(m_program.size());
+    m_program.insert(m_program.end(), code.begin(), code.end());
+    return true;
+  }
+
+  bool DataSchema::run( std::uint32_t block, const DataValue& value ) const
+  {
+    for(const instruction* it = &m_program[block]; ; ++it){
+      switch(it->op)
+      {
+      case op_end:
+        return true;
+
+      case op_type:
+        if(((1u << value.type()) & it->a) == 0) return false;
+        break;
+
+      case op_enum:
+        {
+          bool found = false;
+          for(std::uint32_t i = it->a; i < it->a + it->b && !found; ++i){
+            found = value.equals(m_constants[i]);
+          }
+          if(!found) return false;
+        }
+        break;
+
+      case op_minimum:
+        if(is_number(value)){
+          const double x = value.as_double();
+          if(it->b ? !(x > it->number) : !(x >= it->number)) return false;
+        }
+        break;
+
+      case op_maximum:
+        if(is_number(value)){
+          const double x = value.as_double();
+          if(it->b ? !(x < it->number) : !(x <= it->number)) return false;
+        }
+        break;
+
+      case op_min_length:
+        if(value.is_string() && code_points(value) < it->a) return false;
+        break;
+
+      case op_max_length:
+        if(value.is_string() && code_points(value) > it->a) return false;
+        break;
+
+      case op_min_items:
+        if(value.is_array() && value.size() < it->a) return false;
+        break;
+
+      case op_max_items:
+        if(value.is_array() && value.size() > it->a) return false;
+        break;
+
+      case op_items:
+        if(value.is_array()){
+          for(size_type i = 0; i < value.size(); ++i){
+            if(!run(it->a, value.at(i))) return false;
+          }
+        }
+        break;
+
+      case op_required:
+        if(value.is_object() && !value.has_member(m_names[it->a])) return false;
+        break;
+
+      case op_property:
+        {
+          const DataValue* member = value.find_member(m_names[it->a]);
+          if(member && !run(it->b, *member)) return false;
+        }
+        break;
+
+      case op_closed_properties:
+        if(value.is_object()){
+          const auto first = m_names.begin() + it->a;
+          const auto last  = first + it->b;
+
+          bool result = true;
+          value.for_each_member([&](key_handle name, const DataValue&){
+            result = result && std::binary_search(first, last, name);
+          });
+          if(!result) return false;
+        }
+        break;
+      }
+    }
+  }
+
+} // namespace serial
@@ -8,6 +8,13 @@
 
 #include <limits>
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <utility>
 
 namespace serial{
 
@@ -27,14 +34,104 @@ namespace serial{
   static constexpr std::uint64_t uint64_t_min = std::numeric_limits<std::uint64_t>::min();
   static constexpr std::uint64_t uint64_t_max = std::numeric_limits<std::uint64_t>::max();
 
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  /// \brief Three-way compares two scalars without risking overflow
+  template<typename T>
+  static inline int compare_scalar( const T& lhs, const T& rhs )
+  {
+    return (lhs < rhs) ? -1 : (rhs < lhs) ? 1 : 0;
+  }
+
+  /// \brief Three-way compares two strings bytewise
+  static inline int compare_strings( std::string_view lhs, std::string_view rhs )
+  {
+    const std::size_t count = std::min(lhs.size(), rhs.size());
+    if(count){
+      int result = std::memcmp(lhs.data(), rhs.data(), count);
+      if(result) return (result < 0) ? -1 : 1;
+    }
+    return compare_scalar(lhs.size(), rhs.size());
+  }
+
+  /// \brief Gets the range flags of a signed integer
+  static inline std::uint8_t signed_ranges( std::int64_t x ) noexcept
+  {
+    std::uint8_t result = DataValue::fits_int64 | DataValue::fits_double;
+    if(x >= int32_t_min && x <= int32_t_max) result |= DataValue::fits_int;
+    if(x >= 0){
+      result |= DataValue::fits_uint64;
+      if(x <= static_cast<std::int64_t>(uint32_t_max)) result |= DataValue::fits_uint;
+    }
+    return result;
+  }
+
+  /// \brief Gets the range flags of an unsigned integer
+  static inline std::uint8_t unsigned_ranges( std::uint64_t x ) noexcept
+  {
+    std::uint8_t result = DataValue::fits_uint64 | DataValue::fits_double;
+    if(x <= static_cast<std::uint64_t>(int32_t_max))  result |= DataValue::fits_int;
+    if(x <= static_cast<std::uint64_t>(uint32_t_max)) result |= DataValue::fits_uint;
+    if(x <= static_cast<std::uint64_t>(int64_t_max))  result |= DataValue::fits_int64;
+    return result;
+  }
+
+  /// \brief Gets the range flags of a double; a double fits an integer type
+  ///        if it is in range once truncated. NaN fits none
+  static inline std::uint8_t double_ranges( double x ) noexcept
+  {
+    // 2^63 and 2^64 are exact as doubles, unlike int64_t_max and uint64_t_max
+    static constexpr double two_63 = 9223372036854775808.0;
+    static constexpr double two_64 = 18446744073709551616.0;
+
+    std::uint8_t result = DataValue::fits_double;
+    if(x >= static_cast<double>(int32_t_min) && x <= static_cast<double>(int32_t_max)) result |= DataValue::fits_int;
+    if(x >= 0.0 && x <= static_cast<double>(uint32_t_max)) result |= DataValue::fits_uint;
+    if(x >= -two_63 && x < two_63) result |= DataValue::fits_int64;
+    if(x >= 0.0 && x < two_64)     result |= DataValue::fits_uint64;
+    return result;
+  }
+
+  /// \brief Mixes \p value into \p seed
+  static inline void hash_combine( std::size_t& seed, std::uint64_t value )
+  {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    seed  ^= static_cast<std::size_t>(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+  }
+
+  /// \brief Parses \p str as by \c DataValue::set_number, yielding null if
+  ///        it does not spell a number
+  static inline DataValue parse_number( std::string_view str )
+  {
+    DataValue result;
+    result.set_number(str);
+    return result;
+  }
+
+  /// \brief Checks whether \p str spells a number that is convertable to
+  ///        the numeric type \p x
+  static inline bool number_convertable_to( std::string_view str, DataValue::data_type x )
+  {
+    const DataValue number = parse_number(str);
+    return !number.is_null() && number.is_convertable_to(x);
+  }
+
+  constexpr DataValue::size_type DataValue::max_number_chars;
+
   //--------------------------------------------------------------------------
   // Constructor/Destructor
   //--------------------------------------------------------------------------
 
   DataValue::DataValue( data_type type )
-    : m_type(type)
+    : m_type(type_null),
+      m_ranges(0),
+      m_sliced(false)
   {
-    switch(m_type)
+    switch(type)
     {
     case type_null:
       set_null();
@@ -71,21 +168,27 @@ namespace serial{
 
   DataValue::DataValue( bool x )
     : m_data(x),
-      m_type(type_bool)
+      m_type(type_bool),
+      m_ranges(0),
+      m_sliced(false)
   {
 
   }
 
   DataValue::DataValue( std::int32_t x )
     : m_data(x),
-      m_type(type_int)
+      m_type(type_int),
+      m_ranges(signed_ranges(x)),
+      m_sliced(false)
   {
 
   }
 
   DataValue::DataValue( std::uint32_t x )
     : m_data(x),
-      m_type(type_uint)
+      m_type(type_uint),
+      m_ranges(unsigned_ranges(x)),
+      m_sliced(false)
   {
 
   }
@@ -93,63 +196,117 @@ namespace serial{
 
   DataValue::DataValue( std::int64_t x )
     : m_data(x),
-      m_type(type_int64)
+      m_type(type_int64),
+      m_ranges(signed_ranges(x)),
+      m_sliced(false)
   {
 
   }
 
   DataValue::DataValue( std::uint64_t x )
     : m_data(x),
-      m_type(type_uint64)
+      m_type(type_uint64),
+      m_ranges(unsigned_ranges(x)),
+      m_sliced(false)
   {
 
   }
 
   DataValue::DataValue( double x )
     : m_data(x),
-      m_type(type_double)
+      m_type(type_double),
+      m_ranges(double_ranges(x)),
+      m_sliced(false)
   {
 
   }
 
 
+  DataValue::DataValue( const DataValue& x )
+    : m_type(type_null),
+      m_ranges(0),
+      m_sliced(false)
+  {
+    copy_data(x);
+  }
+
   DataValue& DataValue::operator = ( const DataValue& x )
   {
+    if(this == &x) return (*this);
+
+    // Copy first, since 'x' may be owned by this tree
+    DataValue copy(x);
     clear();
-    m_type = x.m_type;
+    move_data(copy);
+    return (*this);
+  }
 
-    // Copy the value depending on the type
-    switch(m_type)
-    {
-    case type_null:
-      m_data.m_null = nullptr;
-      break;
-    case type_bool:
-      m_data.m_bool = x.m_data.m_bool;
-      break;
-    case type_int:
-      // no break
-    case type_uint:
-      m_data.m_uint = x.m_data.m_uint;
-      break;
-    case type_int64:
-      // no break
-    case type_uint64:
-      m_data.m_uint64 = x.m_data.m_uint64;
-      break;
-    case type_double:
-      m_data.m_double = x.m_data.m_double;
-      break;
-    case type_string:
-      new (&m_data) std::string(x.m_data.m_string);
-      break;
-    case type_array:
-      new (&m_data) array_values();
-      break;
-    case type_object:
-      new (&m_data) object_values();
-      break;
+  DataValue DataValue::clone() const
+  {
+    DataValue result;
+    std::vector<std::pair<const DataValue*,DataValue*>> stack;
+
+    // Scalars are copied directly; containers get storage of their own and
+    // are queued so that their children are copied in turn
+    const auto copy = [&stack]( const DataValue& source, DataValue& target ){
+      switch(source.m_type)
+      {
+      case type_array:
+        target.set_array();
+        target.reserve(source.array_data().size());
+        stack.emplace_back(&source, &target);
+        break;
+      case type_object:
+        target.set_object();
+        stack.emplace_back(&source, &target);
+        break;
+      default:
+        target.copy_data(source);
+        break;
+      }
+    };
+
+    copy(*this, result);
+    while(!stack.empty()){
+      const DataValue& source = *stack.back().first;
+      DataValue&       target = *stack.back().second;
+      stack.pop_back();
+
+      if(source.m_type == type_array){
+        array_values& values = *target.m_data.m_array;
+        for(const auto& x : source.array_data()){
+          values.emplace_back(new DataValue);
+          copy(*x, *values.back());
+        }
+      }else{
+        object_values& values = *target.m_data.m_object;
+        for(const auto& x : source.object_data()){
+          auto it = values.emplace_hint(values.end(), x.first, data_entry(new DataValue));
+          copy(*x.second, *it->second);
+        }
+      }
     }
+    return result;
+  }
+
+  //--------------------------------------------------------------------------
+
+  DataValue::DataValue( DataValue&& x )
+    : m_type(type_null),
+      m_ranges(0),
+      m_sliced(false)
+  {
+    move_data(x);
+  }
+
+  DataValue& DataValue::operator = ( DataValue&& x )
+  {
+    if(this == &x) return (*this);
+
+    // Take ownership first, since 'x' may be owned by this tree
+    DataValue temp(std::move(x));
+    clear();
+    move_data(temp);
     return (*this);
   }
 
@@ -176,8 +333,8 @@ namespace serial{
   DataValue::size_type DataValue::size() const
   {
     switch(m_type){
-    case type_object: return m_data.m_object.size();
-    case type_array:  return m_data.m_array.size();
+    case type_object: return object_data().size();
+    case type_array:  return array_data().size();
     case type_null:   return 0;
     default:
       break;
@@ -190,6 +347,151 @@ namespace serial{
     return size() == 0;
   }
 
+  DataValue::size_type DataValue::capacity() const
+  {
+    return (m_type == type_array) ? array_data().capacity() : size();
+  }
+
+  void DataValue::reserve( size_type n )
+  {
+    if(m_type != type_array || n <= array_data().capacity()) return;
+
+    mutable_array().reserve(n);
+  }
+
+  DataValue::shape_statistics DataValue::statistics() const
+  {
+    // Bookkeeping of the shared storage block (its owner count) and,
+    // approximately, of a red-black tree node (color, parent, left and right)
+    static constexpr size_type shared_block_overhead = sizeof(std::atomic<std::size_t>);
+    static constexpr size_type map_node_overhead     = 4 * sizeof(void*);
+
+    const size_type small_string = std::string().capacity();
+
+    shape_statistics result;
+    std::fill(std::begin(result.nodes), std::end(result.nodes), size_type(0));
+    std::fill(std::begin(result.key_lengths), std::end(result.key_lengths), size_type(0));
+    result.node_bytes        = 0;
+    result.string_bytes      = 0;
+    result.container_bytes   = 0;
+    result.max_depth         = 0;
+    result.largest_array     = 0;
+    result.largest_object    = 0;
+    result.shared_containers = 0;
+
+    const auto string_bytes = [small_string]( const std::string& str ) -> size_type {
+      return (str.capacity() > small_string) ? str.capacity() + 1 : 0;
+    };
+
+    std::vector<std::pair<const DataValue*,size_type>> stack;
+    stack.emplace_back(this, 0);
+
+    while(!stack.empty()){
+      const DataValue* node  = stack.back().first;
+      const size_type  depth = stack.back().second;
+      stack.pop_back();
+
+      ++result.nodes[node->m_type];
+      result.node_bytes += sizeof(DataValue);
+      result.max_depth   = std::max(result.max_depth, depth);
+
+      switch(node->m_type)
+      {
+      case type_string:
+        // Slices reference memory owned outside of the tree
+        if(!node->m_sliced){
+          result.string_bytes += string_bytes(node->m_data.m_string);
+        }
+        break;
+      case type_array:
+        {
+          const array_values& values = node->array_data();
+          result.largest_array    = std::max(result.largest_array, values.size());
+          result.container_bytes += shared_block_overhead + sizeof(array_values) +
+                                    values.capacity() * sizeof(data_entry);
+          result.shared_containers += node->is_shared() ? 1 : 0;
+
+          for(const auto& x : values){
+            stack.emplace_back(x.get(), depth + 1);
+          }
+        }
+        break;
+      case type_object:
+        {
+          const object_values& values = node->object_data();
+          result.largest_object   = std::max(result.largest_object, values.size());
+          result.container_bytes += shared_block_overhead + sizeof(object_values) +
+                                    values.size() * (map_node_overhead + sizeof(object_values::value_type));
+          result.shared_containers += node->is_shared() ? 1 : 0;
+
+          for(const auto& x : values){
+            const size_type length = x.first.name().size();
+            size_type bucket = 0;
+            while(bucket + 1 < shape_statistics::key_length_buckets && (length >> bucket)){
+              ++bucket;
+            }
+            ++result.key_lengths[bucket];
+
+            stack.emplace_back(x.second.get(), depth + 1);
+          }
+        }
+        break;
+      default:
+        break;
+      }
+    }
+    return result;
+  }
+
+  bool DataValue::exceeds_depth( size_type limit ) const
+  {
+    std::vector<std::pair<const DataValue*,size_type>> stack;
+    stack.emplace_back(this, 0);
+
+    while(!stack.empty()){
+      const DataValue* node  = stack.back().first;
+      const size_type  depth = stack.back().second + 1;
+      stack.pop_back();
+
+      const auto visit = [&]( const DataValue& child ){
+        if(child.m_type == type_array || child.m_type == type_object){
+          stack.emplace_back(&child, depth);
+        }
+      };
+
+      if(node->m_type == type_array && !node->array_data().empty()){
+        if(depth > limit) return true;
+        for(const auto& x : node->array_data()){
+          visit(*x);
+        }
+      }else if(node->m_type == type_object && !node->object_data().empty()){
+        if(depth > limit) return true;
+        for(const auto& x : node->object_data()){
+          visit(*x.second);
+        }
+      }
+    }
+    return false;
+  }
+
+  //--------------------------------------------------------------------------
+
+  constexpr DataValue::size_type DataValue::shape_statistics::key_length_buckets;
+
+  DataValue::size_type DataValue::shape_statistics::total_nodes() const
+  {
+    size_type result = 0;
+    for(size_type x : nodes){
+      result += x;
+    }
+    return result;
+  }
+
+  DataValue::size_type DataValue::shape_statistics::total_bytes() const
+  {
+    return node_bytes + string_bytes + container_bytes;
+  }
+
   //--------------------------------------------------------------------------
   // Setters
   //--------------------------------------------------------------------------
@@ -215,6 +517,7 @@ namespace serial{
     clear();
 
     m_type       = type_int;
+    m_ranges     = signed_ranges(x);
     m_data.m_int = x;
   }
 
@@ -223,6 +526,7 @@ namespace serial{
     clear();
 
     m_type        = type_uint;
+    m_ranges      = unsigned_ranges(x);
     m_data.m_uint = x;
   }
 
@@ -231,6 +535,7 @@ namespace serial{
     clear();
 
     m_type         = type_int64;
+    m_ranges       = signed_ranges(x);
     m_data.m_int64 = x;
   }
 
@@ -238,7 +543,8 @@ namespace serial{
   {
     clear();
 
-    m_type = type_uint64;
+    m_type          = type_uint64;
+    m_ranges        = unsigned_ranges(x);
     m_data.m_uint64 = x;
   }
 
@@ -246,7 +552,8 @@ namespace serial{
   {
     clear();
 
-    m_type = type_double;
+    m_type          = type_double;
+    m_ranges        = double_ranges(x);
     m_data.m_double = x;
   }
 
@@ -258,13 +565,62 @@ namespace serial{
     new (&m_data) std::string(str);
   }
 
+  void DataValue::set_string_view( std::string_view str )
+  {
+    set_string_view(str, nullptr);
+  }
+
+  void DataValue::set_string_view( std::string_view str,
+                                   std::shared_ptr<const void> owner )
+  {
+    clear();
+
+    m_type   = type_string;
+    m_sliced = true;
+    new (&m_data.m_slice) string_slice{str.data(), str.size(), std::move(owner)};
+  }
+
+  bool DataValue::set_number( std::string_view str )
+  {
+    const char* const first = str.data();
+    const char* const last  = first + str.size();
+
+    std::int64_t integer;
+    auto result = std::from_chars(first, last, integer);
+    if(result.ec == std::errc() && result.ptr == last){
+      if(integer >= int32_t_min && integer <= int32_t_max){
+        set_int(static_cast<std::int32_t>(integer));
+      }else{
+        set_int64(integer);
+      }
+      return true;
+    }
+
+    // Only positive integers beyond the range of int64 get here
+    std::uint64_t unsigned_integer;
+    result = std::from_chars(first, last, unsigned_integer);
+    if(result.ec == std::errc() && result.ptr == last){
+      set_uint64(unsigned_integer);
+      return true;
+    }
+
+    // from_chars also accepts "inf" and "nan", which are not numbers here
+    double real;
+    result = std::from_chars(first, last, real);
+    if(result.ec == std::errc() && result.ptr == last && std::isfinite(real)){
+      set_double(real);
+      return true;
+    }
+    return false;
+  }
+
   void DataValue::set_array()
   {
     if( m_type == type_array ) return;
     clear();
 
     m_type  = type_array;
-    new (&m_data) std::unique_ptr<array_values>();
+    new (&m_data.m_array) shared_array(shared_array::make());
   }
 
   void DataValue::set_object()
@@ -273,7 +629,7 @@ namespace serial{
     clear();
 
     m_type  = type_object;
-    new (&m_data) std::unique_ptr<object_values>();
+    new (&m_data.m_object) shared_object(shared_object::make());
   }
 
   //--------------------------------------------------------------------------
@@ -286,208 +642,256 @@ namespace serial{
 
     data_entry entry = data_entry(new DataValue(value));
 
-    m_data.m_array.push_back(std::move(entry));
+    mutable_array().push_back(std::move(entry));
     return (*this);
   }
 
   DataValue& DataValue::add_member( const std::string& name, const DataValue& value )
   {
+    return add_member(KeyTable::intern(name), value);
+  }
+
+  DataValue& DataValue::add_member( key_handle key, const DataValue& value )
+  {
+    if(!key.valid()) return (*this);
+
     set_object();
 
     data_entry entry = data_entry(new DataValue(value));
-    m_data.m_object[name] = std::move(entry);
+    mutable_object()[key] = std::move(entry);
     return (*this);
   }
 
-  void DataValue::clear()
+  DataValue& DataValue::add_member( DataValue&& value )
   {
-    if( (m_type==type_object || m_type == type_array || m_type == type_string) && m_data.m_ptr )
-    {
-      // Destruct the types
-      switch(m_type){
-      case type_string:
-        m_data.m_string.~basic_string<char>();
-        break;
-      case type_array:
-        m_data.m_array.~vector<data_entry>();
-        break;
-      case type_object:
-        m_data.m_object.~map<std::string,data_entry>();
-        break;
-      default:
-        break;
-      }
+    if(is_null()){
+      set_array();
     }
-  }
 
-  //--------------------------------------------------------------------------
-  // Type Queries
-  //--------------------------------------------------------------------------
+    data_entry entry = data_entry(new DataValue(std::move(value)));
 
-  bool DataValue::is_null() const
-  {
-    return (m_type == type_null);
+    mutable_array().push_back(std::move(entry));
+    return (*this);
   }
 
-  bool DataValue::is_bool() const
+  DataValue& DataValue::add_member( const std::string& name, DataValue&& value )
   {
-    return m_type == type_bool;
+    return add_member(KeyTable::intern(name), std::move(value));
   }
 
-  bool DataValue::is_numeric() const
+  DataValue& DataValue::add_member( key_handle key, DataValue&& value )
   {
-    return (is_integral() || is_double());
-  }
+    if(!key.valid()) return (*this);
 
-  bool DataValue::is_integral() const
-  {
-    return (is_int() || is_uint() || is_int64() || is_uint64());
+    set_object();
+
+    data_entry entry = data_entry(new DataValue(std::move(value)));
+    mutable_object()[key] = std::move(entry);
+    return (*this);
   }
 
-  bool DataValue::is_int() const
+  bool DataValue::remove_member( const std::string& name )
   {
-    switch(m_type){
-    case type_int:
-      return true;
-    case type_uint:
-      return m_data.m_uint <= static_cast<std::uint32_t>(int32_t_max);
-    case type_int64:
-      return m_data.m_int64 >= static_cast<std::int64_t>(int32_t_min) &&
-             m_data.m_int64 <= static_cast<std::int64_t>(int32_t_max);
-    case type_uint64:
-      return m_data.m_uint64 <= static_cast<std::uint64_t>(int32_t_max);
-    case type_double:
-      return m_data.m_double >= static_cast<double>(int32_t_min) &&
-             m_data.m_double <= static_cast<double>(int32_t_max);
-    default:
-      break;
-    }
-    return false;
+    return remove_member(KeyTable::find(name));
   }
 
-  bool DataValue::is_uint() const
+  bool DataValue::remove_member( key_handle key )
   {
-    switch(m_type){
-    case type_int:
-      return m_data.m_int >= static_cast<std::uint32_t>(uint32_t_min) &&
-             m_data.m_int <= static_cast<std::uint32_t>(uint32_t_max);
-    case type_uint:
-      return true;
-    case type_int64:
-      return m_data.m_int64 >= static_cast<std::int64_t>(uint32_t_min) &&
-             m_data.m_int64 <= static_cast<std::int64_t>(uint32_t_max);
-    case type_uint64:
-      return m_data.m_uint64 <= static_cast<std::uint64_t>(uint32_t_max);
-    case type_double:
-      return m_data.m_double >= static_cast<double>(uint32_t_min) &&
-             m_data.m_double <= static_cast<double>(uint32_t_max);
-    default:
-      break;
-    }
-    return false;
+    return release_member(key) != nullptr;
   }
 
-  bool DataValue::is_int64() const
+  bool DataValue::erase( size_type i )
   {
-    switch(m_type){
-    case type_int:
-      return true;
-    case type_uint:
-      return true;
-    case type_int64:
-      return true;
-    case type_uint64:
-      return m_data.m_uint64 <= static_cast<std::uint64_t>(int64_t_max);
-    case type_double:
-      return m_data.m_double >= static_cast<double>(int64_t_min) &&
-             m_data.m_double <= static_cast<double>(int64_t_max);
-    default:
-      break;
-    }
-    return false;
+    return release_element(i) != nullptr;
   }
 
-  bool DataValue::is_uint64() const
+  DataValue DataValue::take_member( const std::string& name )
   {
-    switch(m_type){
-    case type_int:
-      return true;
-    case type_uint:
-      return true;
-    case type_int64:
-      return m_data.m_int64 >= static_cast<std::int64_t>(uint64_t_max);
-    case type_uint64:
-      return true;
-    case type_double:
-      return m_data.m_double >= static_cast<double>(uint64_t_min) &&
-             m_data.m_double <= static_cast<double>(uint64_t_max);
-    default:
-        break;
-    }
-    return false;
+    return take_member(KeyTable::find(name));
   }
 
-  bool DataValue::is_double() const
+  DataValue DataValue::take_member( key_handle key )
   {
-    return m_type == type_double || is_integral();
+    data_entry entry = release_member(key);
+    return entry ? DataValue(std::move(*entry)) : DataValue();
   }
 
-  bool DataValue::is_string() const
+  DataValue DataValue::take_member( size_type i )
   {
-    return m_type == type_string;
+    data_entry entry = release_element(i);
+    return entry ? DataValue(std::move(*entry)) : DataValue();
   }
 
-  bool DataValue::is_array() const
+  bool DataValue::splice( size_type i, DataValue& source, size_type from )
   {
-    return m_type == type_array;
+    if(m_type != type_array || source.m_type != type_array) return false;
+
+    // The element is removed first, so the bound applies to the array
+    // without it when both are the same
+    const size_type size = array_data().size() - ((&source == this) ? 1 : 0);
+    if(i > size || from >= source.array_data().size()) return false;
+    if(source.array_data()[from].get() == this) return false;
+
+    data_entry entry = source.release_element(from);
+    array_values& values = mutable_array();
+    values.insert(values.begin() + static_cast<std::ptrdiff_t>(i), std::move(entry));
+    return true;
   }
 
-  bool DataValue::is_object() const
+  bool DataValue::splice( size_type i, DataValue& source )
   {
-    return m_type == type_object;
+    if(m_type != type_array || source.m_type != type_array || &source == this) return false;
+    if(i > array_data().size()) return false;
+    if(source.array_data().empty()) return true;
+
+    array_values& from   = source.mutable_array();
+    array_values& values = mutable_array();
+    values.insert(values.begin() + static_cast<std::ptrdiff_t>(i),
+                  std::make_move_iterator(from.begin()),
+                  std::make_move_iterator(from.end()));
+    from.clear();
+    return true;
   }
 
-  bool DataValue::is_convertable_to( data_type x ) const
+  bool DataValue::splice( key_handle key, DataValue& source, key_handle from )
   {
-    if(x == m_type) return true;
+    if(m_type != type_object || source.m_type != type_object || !key.valid()) return false;
 
-    switch(x)
-    {
-    case type_null:
-      return (is_numeric() && as_double() == 0.0) ||
-             (m_type == type_bool && as_bool() == false) ||
-             (m_type == type_string && (m_data.m_ptr) && m_data.m_string.empty()) ||
-             (m_type == type_array && (m_data.m_ptr) && m_data.m_array.size() == 0) ||
-             (m_type == type_object && (m_data.m_ptr) && m_data.m_object.size() == 0);
+    const DataValue* moved = source.find_member(from);
+    if(!moved || moved == this) return false;
 
-    case type_bool:
-      return (is_numeric()) ||
-             (m_type == type_null);
+    data_entry entry = source.release_member(from);
+    mutable_object()[key] = std::move(entry);
+    return true;
+  }
 
-    case type_int:
-      return (is_int()) ||
-             (m_type == type_bool) ||
-             (m_type == type_null);
+  bool DataValue::splice( const std::string& name, DataValue& source, const std::string& from )
+  {
+    // A member that cannot be moved must not intern its new name
+    if(m_type != type_object || source.m_type != type_object) return false;
 
-    case type_int64:
-      return (is_int64()) ||
-             (m_type == type_bool) ||
-             (m_type == type_null);
+    const key_handle key = KeyTable::find(from);
+    const DataValue* moved = source.find_member(key);
+    if(!moved || moved == this) return false;
 
-    case type_uint:
-      return (is_uint()) ||
-             (m_type == type_bool) ||
-             (m_type == type_null);
+    return splice(KeyTable::try_intern(name), source, key);
+  }
 
-    case type_uint64:
-      return (is_uint64()) ||
-             (m_type == type_bool) ||
+  void DataValue::clear()
+  {
+    // Destruct the types
+    switch(m_type){
+    case type_string:
+      if(m_sliced){
+        m_data.m_slice.~string_slice();
+      }else{
+        m_data.m_string.~basic_string<char>();
+      }
+      break;
+    case type_array:
+      // no break
+    case type_object:
+      {
+        // Nested containers are destroyed here, one at a time, rather than
+        // through recursive destructors
+        std::vector<data_entry> pending;
+        release_children(pending);
+        while(!pending.empty()){
+          data_entry node = std::move(pending.back());
+          pending.pop_back();
+          node->release_children(pending);
+        }
+      }
+      if(m_type == type_array){
+        m_data.m_array.~shared_array();
+      }else{
+        m_data.m_object.~shared_object();
+      }
+      break;
+    default:
+      break;
+    }
+    m_type        = type_null;
+    m_ranges      = 0;
+    m_sliced      = false;
+    m_data.m_null = nullptr;
+  }
+
+  //--------------------------------------------------------------------------
+  // Type Queries
+  //--------------------------------------------------------------------------
+
+  bool DataValue::is_null() const
+  {
+    return (m_type == type_null);
+  }
+
+  bool DataValue::is_bool() const
+  {
+    return m_type == type_bool;
+  }
+
+  bool DataValue::is_string() const
+  {
+    return m_type == type_string;
+  }
+
+  bool DataValue::is_array() const
+  {
+    return m_type == type_array;
+  }
+
+  bool DataValue::is_object() const
+  {
+    return m_type == type_object;
+  }
+
+  bool DataValue::is_convertable_to( data_type x ) const
+  {
+    if(x == m_type) return true;
+
+    switch(x)
+    {
+    case type_null:
+      return (is_numeric() && as_double() == 0.0) ||
+             (m_type == type_bool && as_bool() == false) ||
+             (m_type == type_string && as_string_view().empty()) ||
+             (m_type == type_array && array_data().empty()) ||
+             (m_type == type_object && object_data().empty());
+
+    case type_bool:
+      return (is_numeric()) ||
              (m_type == type_null);
 
+    case type_int:
+      return (is_int()) ||
+             (m_type == type_bool) ||
+             (m_type == type_null) ||
+             (m_type == type_string && number_convertable_to(as_string_view(), x));
+
+    case type_int64:
+      return (is_int64()) ||
+             (m_type == type_bool) ||
+             (m_type == type_null) ||
+             (m_type == type_string && number_convertable_to(as_string_view(), x));
+
+    case type_uint:
+      return (is_uint()) ||
+             (m_type == type_bool) ||
+             (m_type == type_null) ||
+             (m_type == type_string && number_convertable_to(as_string_view(), x));
+
+    case type_uint64:
+      return (is_uint64()) ||
+             (m_type == type_bool) ||
+             (m_type == type_null) ||
+             (m_type == type_string && number_convertable_to(as_string_view(), x));
+
     case type_double:
       return (is_double()) ||
              (m_type == type_bool) ||
-             (m_type == type_null);
+             (m_type == type_null) ||
+             (m_type == type_string && number_convertable_to(as_string_view(), x));
 
     case type_string:
       return (is_numeric()) ||
@@ -506,6 +910,30 @@ namespace serial{
     return false;
   }
 
+  bool DataValue::is_shared() const
+  {
+    switch(m_type)
+    {
+    case type_array:  return !m_data.m_array.unique();
+    case type_object: return !m_data.m_object.unique();
+    default: break;
+    }
+    return false;
+  }
+
+  bool DataValue::shares_with( const DataValue& x ) const
+  {
+    if(m_type != x.m_type) return false;
+
+    switch(m_type)
+    {
+    case type_array:  return m_data.m_array == x.m_data.m_array;
+    case type_object: return m_data.m_object == x.m_data.m_object;
+    default: break;
+    }
+    return false;
+  }
+
   //-------------------------------------------------------------------------
   // Type Access
   //-------------------------------------------------------------------------
@@ -538,6 +966,7 @@ namespace serial{
     case type_double: return static_cast<std::int32_t>(m_data.m_double);
     case type_bool:   return (m_data.m_bool ? 1 : 0);
     case type_null:   return 0;
+    case type_string: return parse_number(as_string_view()).as_int();
     default: break;
     }
 
@@ -557,6 +986,7 @@ namespace serial{
     case type_double: return static_cast<std::uint32_t>(m_data.m_double);
     case type_bool:   return (m_data.m_bool ? 1 : 0);
     case type_null:   return 0;
+    case type_string: return parse_number(as_string_view()).as_uint();
     default: break;
     }
 
@@ -577,6 +1007,7 @@ namespace serial{
     case type_double: return static_cast<std::int64_t>(m_data.m_double);
     case type_bool:   return (m_data.m_bool ? 1 : 0);
     case type_null:   return 0;
+    case type_string: return parse_number(as_string_view()).as_int64();
     default: break;
     }
 
@@ -596,6 +1027,7 @@ namespace serial{
     case type_double: return static_cast<std::uint64_t>(m_data.m_double);
     case type_bool:   return (m_data.m_bool ? 1 : 0);
     case type_null:   return 0;
+    case type_string: return parse_number(as_string_view()).as_uint64();
     default: break;
     }
 
@@ -615,16 +1047,86 @@ namespace serial{
     case type_double: return m_data.m_double;
     case type_bool:   return (m_data.m_bool ? 1.0 : 0.0);
     case type_null:   return 0.0;
+    case type_string: return parse_number(as_string_view()).as_double();
     default: break;
     }
 
     return m_data.m_double;
   }
 
+  bool DataValue::try_as_int( std::int32_t& out ) const
+  {
+    return try_as_number(out, fits_int);
+  }
+
+  bool DataValue::try_as_uint( std::uint32_t& out ) const
+  {
+    return try_as_number(out, fits_uint);
+  }
+
+  bool DataValue::try_as_int64( std::int64_t& out ) const
+  {
+    return try_as_number(out, fits_int64);
+  }
+
+  bool DataValue::try_as_uint64( std::uint64_t& out ) const
+  {
+    return try_as_number(out, fits_uint64);
+  }
+
+  bool DataValue::try_as_double( double& out ) const
+  {
+    return try_as_number(out, fits_double);
+  }
+
   std::string DataValue::as_string() const
   {
-    // Throw is not string
-    return m_data.m_string;
+    if(m_type == type_string){
+      return std::string(as_string_view());
+    }
+
+    char buffer[max_number_chars];
+    char* last = to_chars(buffer, buffer + max_number_chars);
+    return last ? std::string(buffer, last) : std::string();
+  }
+
+  char* DataValue::to_chars( char* first, char* last ) const
+  {
+    const auto copy = [first, last]( std::string_view str ) -> char* {
+      if(str.size() > static_cast<size_type>(last - first)) return nullptr;
+      if(!str.empty()) std::memcpy(first, str.data(), str.size());
+      return first + str.size();
+    };
+
+    std::to_chars_result result{nullptr, std::errc::value_too_large};
+    switch(m_type)
+    {
+    case type_null:   return first;
+    case type_bool:   return copy(m_data.m_bool ? "true" : "false");
+    case type_int:    result = std::to_chars(first, last, m_data.m_int); break;
+    case type_uint:   result = std::to_chars(first, last, m_data.m_uint); break;
+    case type_int64:  result = std::to_chars(first, last, m_data.m_int64); break;
+    case type_uint64: result = std::to_chars(first, last, m_data.m_uint64); break;
+    case type_double: result = std::to_chars(first, last, m_data.m_double); break;
+    case type_string: return copy(as_string_view());
+    default: break;
+    }
+    return (result.ec == std::errc()) ? result.ptr : nullptr;
+  }
+
+  bool DataValue::is_string_view() const
+  {
+    return m_type == type_string && m_sliced;
+  }
+
+  const char* DataValue::string_data() const
+  {
+    return (m_type == type_string) ? as_string_view().data() : nullptr;
+  }
+
+  DataValue::size_type DataValue::string_length() const
+  {
+    return as_string_view().size();
   }
 
   DataValue* DataValue::as_array()
@@ -639,6 +1141,77 @@ namespace serial{
     return this;
   }
 
+  //--------------------------------------------------------------------------
+  // Bulk Extraction
+  //--------------------------------------------------------------------------
+
+  template<typename T>
+  DataValue::size_type DataValue::copy_numbers( T* out,
+                                                size_type count,
+                                                std::uint8_t mask ) const
+  {
+    if(m_type != type_array) return 0;
+
+    const array_values& values = array_data();
+    const size_type     size   = std::min(count, values.size());
+
+    for(size_type i = 0; i < size; ++i){
+      const DataValue& x = *values[i];
+      if(!(x.m_ranges & mask)) return i;
+
+      switch(x.m_type)
+      {
+      case type_int:    out[i] = static_cast<T>(x.m_data.m_int);    break;
+      case type_uint:   out[i] = static_cast<T>(x.m_data.m_uint);   break;
+      case type_int64:  out[i] = static_cast<T>(x.m_data.m_int64);  break;
+      case type_uint64: out[i] = static_cast<T>(x.m_data.m_uint64); break;
+      default:          out[i] = static_cast<T>(x.m_data.m_double); break;
+      }
+    }
+    return size;
+  }
+
+  template<typename T>
+  bool DataValue::try_as_number( T& out, std::uint8_t mask ) const
+  {
+    // A string is parsed once, into the number that is then converted
+    if(m_type == type_string){
+      DataValue number;
+      return number.set_number(as_string_view()) && number.try_as_number(out, mask);
+    }
+    if(!(m_ranges & mask)) return false;
+
+    switch(m_type)
+    {
+    case type_int:    out = static_cast<T>(m_data.m_int);    break;
+    case type_uint:   out = static_cast<T>(m_data.m_uint);   break;
+    case type_int64:  out = static_cast<T>(m_data.m_int64);  break;
+    case type_uint64: out = static_cast<T>(m_data.m_uint64); break;
+    default:          out = static_cast<T>(m_data.m_double); break;
+    }
+    return true;
+  }
+
+  DataValue::size_type DataValue::copy_to( double* out, size_type count ) const
+  {
+    return copy_numbers(out, count, fits_double);
+  }
+
+  DataValue::size_type DataValue::copy_to( float* out, size_type count ) const
+  {
+    return copy_numbers(out, count, fits_double);
+  }
+
+  DataValue::size_type DataValue::copy_to( std::int32_t* out, size_type count ) const
+  {
+    return copy_numbers(out, count, fits_int);
+  }
+
+  DataValue::size_type DataValue::copy_to( std::int64_t* out, size_type count ) const
+  {
+    return copy_numbers(out, count, fits_int64);
+  }
+
   //--------------------------------------------------------------------------
   // Member Access
   //--------------------------------------------------------------------------
@@ -647,7 +1220,29 @@ namespace serial{
   {
       if(!is_object()) return false;
 
-      return m_data.m_object.find(name) != m_data.m_object.end();
+      return has_member(KeyTable::find(name));
+  }
+
+  bool DataValue::has_member( key_handle key ) const
+  {
+      if(!is_object()) return false;
+
+      return object_data().find(key) != object_data().end();
+  }
+
+  const DataValue* DataValue::find_member( const std::string& name ) const
+  {
+    if(!is_object()) return nullptr;
+
+    return find_member(KeyTable::find(name));
+  }
+
+  const DataValue* DataValue::find_member( key_handle key ) const
+  {
+    if(!is_object()) return nullptr;
+
+    auto it = object_data().find(key);
+    return (it != object_data().end()) ? it->second.get() : nullptr;
   }
 
   DataValue& DataValue::at( size_t i )
@@ -655,7 +1250,7 @@ namespace serial{
     // Throw is not array
     // Throw i < size()
 
-    return *m_data.m_array.at(i);
+    return *mutable_array().at(i);
   }
 
   const DataValue& DataValue::at( size_t i ) const
@@ -663,21 +1258,31 @@ namespace serial{
     // Throw is not array
     // Throw i < size()
 
-    return *m_data.m_array.at(i).get();
+    return *array_data().at(i).get();
   }
 
   DataValue& DataValue::at( const std::string& name )
+  {
+    return at(KeyTable::find(name));
+  }
+
+  const DataValue& DataValue::at( const std::string& name ) const
+  {
+    return at(KeyTable::find(name));
+  }
+
+  DataValue& DataValue::at( key_handle key )
   {
     // Throw is not object
 
-    return *m_data.m_object.at(name).get();
+    return *mutable_object().at(key).get();
   }
 
-  const DataValue& DataValue::at( const std::string& name ) const
+  const DataValue& DataValue::at( key_handle key ) const
   {
     // Throw is not object
 
-    return *m_data.m_object.at(name).get();
+    return *object_data().at(key).get();
   }
 
   //--------------------------------------------------------------------------
@@ -691,41 +1296,230 @@ namespace serial{
 
   int DataValue::compare( const DataValue& value ) const
   {
-    int type_delta = static_cast<int>(m_type) - static_cast<int>(value.m_type);
-    if(type_delta){
-      return type_delta;
+    // A pair of containers being compared; arrays advance 'index' and
+    // objects advance the member iterators
+    struct frame
+    {
+      const DataValue*              lhs;
+      const DataValue*              rhs;
+      size_type                     index;
+      object_values::const_iterator lhs_it;
+      object_values::const_iterator rhs_it;
+    };
+
+    std::vector<frame> stack;
+
+    // Compares two nodes, and queues their children if both are the same
+    // kind of container and do not share storage
+    const auto visit = [&stack]( const DataValue& lhs, const DataValue& rhs ){
+      if(&lhs == &rhs) return 0;
+
+      const int result = lhs.compare_shallow(rhs);
+      if(result || (lhs.m_type != type_array && lhs.m_type != type_object) ||
+         lhs.shares_with(rhs)){
+        return result;
+      }
+
+      frame next{&lhs, &rhs, 0, object_values::const_iterator(), object_values::const_iterator()};
+      if(lhs.m_type == type_object){
+        next.lhs_it = lhs.object_data().begin();
+        next.rhs_it = rhs.object_data().begin();
+      }
+      stack.push_back(next);
+      return 0;
+    };
+
+    int result = visit(*this, value);
+    while(!result && !stack.empty()){
+      const size_type depth = stack.size();
+      const frame&    top   = stack.back();
+
+      // Children are compared in place until one has to be descended into
+      if(top.lhs->m_type == type_array){
+        const array_values& lhs_values = top.lhs->array_data();
+        const array_values& rhs_values = top.rhs->array_data();
+        const size_type     count      = std::min(lhs_values.size(), rhs_values.size());
+
+        size_type i = top.index;
+        while(!result && i < count && stack.size() == depth){
+          result = visit(*lhs_values[i], *rhs_values[i]);
+          ++i;
+        }
+        if(stack.size() != depth){
+          stack[depth - 1].index = i;
+          continue;
+        }
+        if(!result){
+          result = compare_scalar(lhs_values.size(), rhs_values.size());
+        }
+      }else{
+        const object_values& lhs_values = top.lhs->object_data();
+        const object_values& rhs_values = top.rhs->object_data();
+
+        auto lhs_it = top.lhs_it;
+        auto rhs_it = top.rhs_it;
+        while(!result && lhs_it != lhs_values.end() && rhs_it != rhs_values.end() &&
+              stack.size() == depth){
+          result = lhs_it->first.compare(rhs_it->first);
+          if(!result){
+            result = visit(*lhs_it->second, *rhs_it->second);
+          }
+          ++lhs_it;
+          ++rhs_it;
+        }
+        if(stack.size() != depth){
+          stack[depth - 1].lhs_it = lhs_it;
+          stack[depth - 1].rhs_it = rhs_it;
+          continue;
+        }
+        if(!result){
+          result = compare_scalar(lhs_values.size(), rhs_values.size());
+        }
+      }
+      stack.pop_back();
     }
+    return result;
+  }
 
-    switch(m_type)
+  bool DataValue::equals( const DataValue& value ) const
+  {
+    std::vector<std::pair<const DataValue*,const DataValue*>> stack;
+
+    // Checks two nodes, and queues their children if both are containers
+    // of the same size that do not share storage
+    const auto visit = [&stack]( const DataValue& lhs, const DataValue& rhs ){
+      if(&lhs == &rhs) return true;
+      if(!lhs.equals_shallow(rhs)) return false;
+
+      if((lhs.m_type == type_array || lhs.m_type == type_object) &&
+         !lhs.shares_with(rhs)){
+        stack.emplace_back(&lhs, &rhs);
+      }
+      return true;
+    };
+
+    if(!visit(*this, value)) return false;
+
+    while(!stack.empty()){
+      const DataValue& lhs = *stack.back().first;
+      const DataValue& rhs = *stack.back().second;
+      stack.pop_back();
+
+      if(lhs.m_type == type_array){
+        const array_values& lhs_values = lhs.array_data();
+        const array_values& rhs_values = rhs.array_data();
+
+        for(size_type i = 0; i < lhs_values.size(); ++i){
+          if(!visit(*lhs_values[i], *rhs_values[i])) return false;
+        }
+      }else{
+        auto rhs_it = rhs.object_data().begin();
+        for(const auto& x : lhs.object_data()){
+          if(x.first != rhs_it->first) return false;
+          if(!visit(*x.second, *(rhs_it++)->second)) return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  std::size_t DataValue::hash() const
+  {
+    // A container being hashed. Arrays combine their children in order
+    // into 'seed'; objects sum the combined key and value hashes of their
+    // members into it, so that the hash does not depend on member order
+    struct frame
     {
-    case type_null:
-      return 0;
-    case type_int:
-      return m_data.m_int - value.m_data.m_int;
-    case type_uint:
-      return (m_data.m_uint < value.m_data.m_uint) ? -1 : (m_data.m_uint > value.m_data.m_uint) ? 1 : 0;
-    case type_int64:
-      return m_data.m_int64 - value.m_data.m_int64;
-    case type_uint64:
-      return (m_data.m_uint64 < value.m_data.m_uint64) ? -1 : (m_data.m_uint64 > value.m_data.m_uint64) ? 1 : 0;
-    case type_double:
-      return (m_data.m_double < value.m_data.m_double) ? -1 : (m_data.m_double > value.m_data.m_double) ? 1 : 0;
-    case type_bool:
-      return m_data.m_bool - value.m_data.m_bool;
-    default:
-      break;
+      const DataValue*              node;
+      std::size_t                   seed;
+      std::size_t                   key;
+      size_type                     index;
+      object_values::const_iterator it;
+    };
+
+    std::vector<frame> stack;
+
+    const auto enter = [&stack]( const DataValue& node ){
+      frame next{&node, static_cast<std::size_t>(node.m_type), 0, 0, object_values::const_iterator()};
+      if(node.m_type == type_array){
+        hash_combine(next.seed, node.array_data().size());
+      }else{
+        next.seed = 0;
+        next.it   = node.object_data().begin();
+      }
+      stack.push_back(next);
+    };
+
+    const auto absorb = []( frame& parent, std::size_t child ){
+      if(parent.node->m_type == type_array){
+        hash_combine(parent.seed, child);
+      }else{
+        std::size_t member = parent.key;
+        hash_combine(member, child);
+        parent.seed += member;
+      }
+    };
+
+    if(m_type != type_array && m_type != type_object){
+      return hash_shallow();
+    }
+    enter(*this);
+
+    while(true){
+      frame& top = stack.back();
+      const DataValue* child = nullptr;
+
+      // Scalar children are hashed in place; containers are descended into
+      if(top.node->m_type == type_array){
+        const array_values& values = top.node->array_data();
+        while(!child && top.index < values.size()){
+          const DataValue& x = *values[top.index++];
+          if(x.m_type == type_array || x.m_type == type_object){
+            child = &x;
+          }else{
+            hash_combine(top.seed, x.hash_shallow());
+          }
+        }
+      }else{
+        const auto end = top.node->object_data().end();
+        while(!child && top.it != end){
+          const DataValue& x = *top.it->second;
+          top.key = top.it->first.hash();
+          ++top.it;
+          if(x.m_type == type_array || x.m_type == type_object){
+            child = &x;
+          }else{
+            absorb(top, x.hash_shallow());
+          }
+        }
+      }
+
+      if(child){
+        enter(*child);
+        continue;
+      }
+
+      // Every child is hashed; finish this container
+      std::size_t result = top.seed;
+      if(top.node->m_type == type_object){
+        result = static_cast<std::size_t>(type_object);
+        hash_combine(result, top.node->object_data().size());
+        hash_combine(result, top.seed);
+      }
+      stack.pop_back();
+
+      if(stack.empty()) return result;
+      absorb(stack.back(), result);
     }
-    return 0;
   }
 
   //--------------------------------------------------------------------------
-  // Private Constructor
+  // Private Member Functions
   //--------------------------------------------------------------------------
 
-  DataValue::DataValue( const DataValue& x )
-    : m_type(x.m_type)
+  void DataValue::copy_data( const DataValue& x )
   {
-    switch(m_type)
+    switch(x.m_type)
     {
     case type_null:
       m_data.m_null = nullptr;
@@ -747,15 +1541,230 @@ namespace serial{
       m_data.m_double = x.m_data.m_double;
       break;
     case type_string:
-      new (&m_data) std::string(x.m_data.m_string);
+      if(x.m_sliced){
+        new (&m_data.m_slice) string_slice(x.m_data.m_slice);
+      }else{
+        new (&m_data.m_string) std::string(x.m_data.m_string);
+      }
       break;
     case type_array:
-      new (&m_data) array_values();
+      new (&m_data.m_array) shared_array(x.m_data.m_array);
       break;
     case type_object:
-      new (&m_data) object_values();
+      new (&m_data.m_object) shared_object(x.m_data.m_object);
       break;
     }
+    m_type   = x.m_type;
+    m_ranges = x.m_ranges;
+    m_sliced = x.m_sliced;
+  }
+
+  void DataValue::move_data( DataValue& x )
+  {
+    switch(x.m_type)
+    {
+    case type_string:
+      if(x.m_sliced){
+        new (&m_data.m_slice) string_slice(std::move(x.m_data.m_slice));
+      }else{
+        new (&m_data.m_string) std::string(std::move(x.m_data.m_string));
+      }
+      break;
+    case type_array:
+      new (&m_data.m_array) shared_array(std::move(x.m_data.m_array));
+      break;
+    case type_object:
+      new (&m_data.m_object) shared_object(std::move(x.m_data.m_object));
+      break;
+    default:
+      copy_data(x);
+      break;
+    }
+    m_type   = x.m_type;
+    m_ranges = x.m_ranges;
+    m_sliced = x.m_sliced;
+    x.clear();
+  }
+
+  DataValue::data_entry DataValue::release_element( size_type i )
+  {
+    if(m_type != type_array || i >= array_data().size()) return nullptr;
+
+    array_values& values = mutable_array();
+    data_entry result = std::move(values[i]);
+    values.erase(values.begin() + static_cast<std::ptrdiff_t>(i));
+    return result;
+  }
+
+  DataValue::data_entry DataValue::release_member( key_handle key )
+  {
+    // Checked on the shared storage first, so that a miss does not clone it
+    if(m_type != type_object || object_data().find(key) == object_data().end()){
+      return nullptr;
+    }
+
+    object_values& values = mutable_object();
+    auto it = values.find(key);
+    data_entry result = std::move(it->second);
+    values.erase(it);
+    return result;
+  }
+
+  void DataValue::release_children( std::vector<data_entry>& pending )
+  {
+    // Entries released earlier are left null
+    const auto release = [&pending]( data_entry& x ){
+      if(x && (x->m_type == type_array || x->m_type == type_object)){
+        pending.push_back(std::move(x));
+      }
+    };
+
+    // Shared storage is left to its other owners
+    if(m_type == type_array && m_data.m_array.unique()){
+      for(auto& x : *m_data.m_array){
+        release(x);
+      }
+    }else if(m_type == type_object && m_data.m_object.unique()){
+      for(auto& x : *m_data.m_object){
+        release(x.second);
+      }
+    }
+  }
+
+  int DataValue::compare_shallow( const DataValue& value ) const
+  {
+    int type_delta = static_cast<int>(m_type) - static_cast<int>(value.m_type);
+    if(type_delta){
+      return type_delta;
+    }
+
+    switch(m_type)
+    {
+    case type_int:
+      return compare_scalar(m_data.m_int, value.m_data.m_int);
+    case type_uint:
+      return compare_scalar(m_data.m_uint, value.m_data.m_uint);
+    case type_int64:
+      return compare_scalar(m_data.m_int64, value.m_data.m_int64);
+    case type_uint64:
+      return compare_scalar(m_data.m_uint64, value.m_data.m_uint64);
+    case type_double:
+      return compare_scalar(m_data.m_double, value.m_data.m_double);
+    case type_bool:
+      return compare_scalar(m_data.m_bool, value.m_data.m_bool);
+    case type_string:
+      return compare_strings(as_string_view(), value.as_string_view());
+    default:
+      break;
+    }
+    return 0;
+  }
+
+  bool DataValue::equals_shallow( const DataValue& value ) const
+  {
+    if(m_type != value.m_type){
+      return false;
+    }
+
+    switch(m_type)
+    {
+    case type_null:
+      return true;
+    case type_bool:
+      return m_data.m_bool == value.m_data.m_bool;
+    case type_int:
+      return m_data.m_int == value.m_data.m_int;
+    case type_uint:
+      return m_data.m_uint == value.m_data.m_uint;
+    case type_int64:
+      return m_data.m_int64 == value.m_data.m_int64;
+    case type_uint64:
+      return m_data.m_uint64 == value.m_data.m_uint64;
+    case type_double:
+      return compare_scalar(m_data.m_double, value.m_data.m_double) == 0;
+    case type_string:
+      {
+        const std::string_view lhs = as_string_view();
+        const std::string_view rhs = value.as_string_view();
+        return lhs.size() == rhs.size() &&
+               std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+      }
+    case type_array:
+      return array_data().size() == value.array_data().size();
+    case type_object:
+      return object_data().size() == value.object_data().size();
+    }
+    return false;
+  }
+
+  std::size_t DataValue::hash_shallow() const
+  {
+    std::size_t seed = static_cast<std::size_t>(m_type);
+
+    switch(m_type)
+    {
+    case type_bool:
+      hash_combine(seed, m_data.m_bool ? 1u : 0u);
+      break;
+    case type_int:
+      hash_combine(seed, static_cast<std::uint64_t>(m_data.m_int));
+      break;
+    case type_uint:
+      hash_combine(seed, static_cast<std::uint64_t>(m_data.m_uint));
+      break;
+    case type_int64:
+      hash_combine(seed, static_cast<std::uint64_t>(m_data.m_int64));
+      break;
+    case type_uint64:
+      hash_combine(seed, m_data.m_uint64);
+      break;
+    case type_double:
+      {
+        // +0.0 and -0.0 compare equal, so they must hash equally too
+        double d = (m_data.m_double == 0.0) ? 0.0 : m_data.m_double;
+        std::uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        hash_combine(seed, bits);
+      }
+      break;
+    case type_string:
+      hash_combine(seed, std::hash<std::string_view>()(as_string_view()));
+      break;
+    default:
+      break;
+    }
+    return seed;
+  }
+
+  DataValue::array_values& DataValue::mutable_array()
+  {
+    // Clone only this level; the cloned children share their own storage.
+    // 'unique' acquires the releases of former owners, so their reads of
+    // the storage happen before it is written in place
+    if(!m_data.m_array.unique()){
+      shared_array copy = shared_array::make();
+      copy->reserve(m_data.m_array->size());
+
+      for(const auto& x : *m_data.m_array){
+        copy->push_back(data_entry(new DataValue(*x)));
+      }
+      m_data.m_array = std::move(copy);
+    }
+    return *m_data.m_array;
+  }
+
+  DataValue::object_values& DataValue::mutable_object()
+  {
+    // Clone only this level; the cloned children share their own storage
+    if(!m_data.m_object.unique()){
+      shared_object copy = shared_object::make();
+
+      for(const auto& x : *m_data.m_object){
+        copy->emplace_hint(copy->end(), x.first, data_entry(new DataValue(*x.second)));
+      }
+      m_data.m_object = std::move(copy);
+    }
+    return *m_data.m_object;
   }
 
 } // namespace serial
@@ -0,0 +1,354 @@
+/**
+ * \file FixedLayout.cpp
+ *
+ * Implementation of \c FixedLayout and the \c FixedWriter and
+ * \c FixedView of its messages
+ */
+#include <FixedLayout.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace serial{
+
+  static_assert(sizeof(int) == sizeof(std::int32_t) && sizeof(float) == 4,
+                "fixed layouts store ints and floats in 4 bytes");
+
+  //--------------------------------------------------------------------------
+  // Static Members
+  //--------------------------------------------------------------------------
+
+  /// The size of the message header, before the offset table
+  static constexpr std::size_t header_size = 8;
+
+  /// The size of a (u32 offset, u32 length) reference
+  static constexpr std::size_t reference_size = 2 * sizeof(std::uint32_t);
+
+  static constexpr std::size_t max_offset = std::numeric_limits<std::uint16_t>::max();
+
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  static inline std::size_t align( std::size_t offset, std::size_t alignment )
+  {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+  static std::size_t slot_size( field_kind kind )
+  {
+    switch(kind)
+    {
+    case field_kind::boolean:  return 1;
+    case field_kind::integer:  return sizeof(std::int32_t);
+    case field_kind::floating: return sizeof(float);
+    default:
+      break;
+    }
+    return reference_size;
+  }
+
+  //--------------------------------------------------------------------------
+  // FixedLayout
+  //--------------------------------------------------------------------------
+
+  constexpr FixedLayout::size_type FixedLayout::npos;
+
+  FixedLayout::FixedLayout()
+    : m_ids(0),
+      m_slots_size(0)
+  {
+
+  }
+
+  const field_layout& FixedLayout::add( key_handle key, field_kind kind )
+  {
+    auto it = m_fields.find(key);
+    if(it != m_fields.end() && it->second.kind == kind){
+      return it->second;
+    }
+
+    const size_type size   = slot_size(kind);
+    const size_type offset = align(m_slots_size, size < 4 ? size : 4);
+    m_slots_size = offset + size;
+
+    // A field that changes kind never reuses its id, so that messages of
+    // the old kind are not misread as the new one
+    const field_layout field = {m_ids++, offset, kind};
+    if(it != m_fields.end()){
+      it->second = field;
+      return it->second;
+    }
+    return m_fields.emplace(key, field).first->second;
+  }
+
+  const field_layout* FixedLayout::find( key_handle key ) const
+  {
+    auto it = m_fields.find(key);
+    return (it != m_fields.end()) ? &it->second : nullptr;
+  }
+
+  FixedLayout::size_type FixedLayout::field_id( const std::string& name ) const
+  {
+    const field_layout* field = find(KeyTable::find(name));
+    return field ? field->id : npos;
+  }
+
+  FixedLayout::size_type FixedLayout::fields() const noexcept
+  {
+    return m_ids;
+  }
+
+  FixedLayout::size_type FixedLayout::slots_offset() const noexcept
+  {
+    return align(header_size + 2 * m_ids, 4);
+  }
+
+  FixedLayout::size_type FixedLayout::fixed_size() const noexcept
+  {
+    return slots_offset() + m_slots_size;
+  }
+
+  //--------------------------------------------------------------------------
+  // FixedWriter
+  //--------------------------------------------------------------------------
+
+  FixedWriter::FixedWriter( const FixedLayout& layout )
+    : m_buffer(align(layout.fixed_size(), 4), 0),
+      m_fields(std::min(layout.fields(), max_offset)),
+      m_slots_offset(layout.slots_offset()),
+      m_dropped(0)
+  {
+    // The offset table is filled in as fields are set
+    store<std::uint16_t>(4, static_cast<std::uint16_t>(m_fields));
+  }
+
+  bool FixedWriter::set( const field_layout& field, bool x )
+  {
+    const size_type offset = slot(field);
+    if(!offset) return false;
+
+    store<std::uint8_t>(offset, x ? 1 : 0);
+    return true;
+  }
+
+  bool FixedWriter::set( const field_layout& field, int x )
+  {
+    const size_type offset = slot(field);
+    if(!offset) return false;
+
+    store<std::int32_t>(offset, static_cast<std::int32_t>(x));
+    return true;
+  }
+
+  bool FixedWriter::set( const field_layout& field, float x )
+  {
+    const size_type offset = slot(field);
+    if(!offset) return false;
+
+    store<float>(offset, x);
+    return true;
+  }
+
+  bool FixedWriter::set( const field_layout& field, std::string_view x )
+  {
+    const size_type offset = slot(field);
+    if(!offset) return false;
+
+    const size_type target = append(x.size(), 1);
+    if(!x.empty()) std::memcpy(m_buffer.data() + target, x.data(), x.size());
+    store_reference(offset, target, x.size());
+    return true;
+  }
+
+  bool FixedWriter::set( const field_layout& field, const bool* values, size_type count )
+  {
+    const size_type offset = slot(field);
+    if(!offset) return false;
+
+    if(!values) count = 0;
+    const size_type target = append(count, 1);
+    for(size_type i = 0; i < count; ++i){
+      store<std::uint8_t>(target + i, values[i] ? 1 : 0);
+    }
+    store_reference(offset, target, count);
+    return true;
+  }
+
+  bool FixedWriter::set( const field_layout& field, const int* values, size_type count )
+  {
+    const size_type offset = slot(field);
+    if(!offset) return false;
+
+    if(!values) count = 0;
+    const size_type target = append(count * sizeof(std::int32_t), 4);
+    if(count) std::memcpy(m_buffer.data() + target, values, count * sizeof(std::int32_t));
+    store_reference(offset, target, count);
+    return true;
+  }
+
+  bool FixedWriter::set( const field_layout& field, const float* values, size_type count )
+  {
+    const size_type offset = slot(field);
+    if(!offset) return false;
+
+    if(!values) count = 0;
+    const size_type target = append(count * sizeof(float), 4);
+    if(count) std::memcpy(m_buffer.data() + target, values, count * sizeof(float));
+    store_reference(offset, target, count);
+    return true;
+  }
+
+  bool FixedWriter::set( const field_layout& field, const std::string* values, size_type count )
+  {
+    const size_type offset = slot(field);
+    if(!offset) return false;
+
+    if(!values) count = 0;
+    const size_type target = append(count * reference_size, 4);
+    for(size_type i = 0; i < count; ++i){
+      const size_type characters = append(values[i].size(), 1);
+      if(!values[i].empty()){
+        std::memcpy(m_buffer.data() + characters, values[i].data(), values[i].size());
+      }
+      store_reference(target + i * reference_size, characters, values[i].size());
+    }
+    store_reference(offset, target, count);
+    return true;
+  }
+
+  std::vector<char> FixedWriter::finish()
+  {
+    store<std::uint32_t>(0, static_cast<std::uint32_t>(m_buffer.size()));
+    return std::move(m_buffer);
+  }
+
+  FixedWriter::size_type FixedWriter::dropped() const noexcept
+  {
+    return m_dropped;
+  }
+
+  //--------------------------------------------------------------------------
+
+  FixedWriter::size_type FixedWriter::slot( const field_layout& field )
+  {
+    // Slots beyond the reach of a 16-bit offset cannot be stored
+    const size_type offset = m_slots_offset + field.offset;
+    if(field.id >= m_fields || offset > max_offset || m_buffer.empty()){
+      ++m_dropped;
+      return 0;
+    }
+
+    store<std::uint16_t>(header_size + 2 * field.id, static_cast<std::uint16_t>(offset));
+    return offset;
+  }
+
+  FixedWriter::size_type FixedWriter::append( size_type bytes, size_type alignment )
+  {
+    const size_type offset = align(m_buffer.size(), alignment);
+    m_buffer.resize(offset + bytes, 0);
+    return offset;
+  }
+
+  void FixedWriter::store_reference( size_type offset, size_type target, size_type length )
+  {
+    store<std::uint32_t>(offset, static_cast<std::uint32_t>(target));
+    store<std::uint32_t>(offset + sizeof(std::uint32_t), static_cast<std::uint32_t>(length));
+  }
+
+  //--------------------------------------------------------------------------
+  // FixedView
+  //--------------------------------------------------------------------------
+
+  FixedView::FixedView( const void* data, size_type size )
+    : m_data(static_cast<const char*>(data)),
+      m_size(0),
+      m_fields(0)
+  {
+    if(!data || size < header_size) return;
+
+    const size_type message = load<std::uint32_t>(0);
+    const size_type fields  = load<std::uint16_t>(4);
+    if(message > size || header_size + 2 * fields > message) return;
+
+    m_size   = message;
+    m_fields = fields;
+  }
+
+  FixedView::size_type FixedView::get_size( size_type id ) const noexcept
+  {
+    // Every element takes at least a byte, so a length that does not fit
+    // the message as bytes is corrupt
+    size_type target, length;
+    const size_type offset = slot(id, reference_size);
+    if(!offset || !load_reference(offset, 1, target, length)) return 0;
+
+    return length;
+  }
+
+  std::string_view FixedView::get_string( size_type id ) const noexcept
+  {
+    size_type target, length;
+    const size_type offset = slot(id, reference_size);
+    if(!offset || !load_reference(offset, 1, target, length)) return std::string_view();
+
+    return std::string_view(m_data + target, length);
+  }
+
+  bool FixedView::get_bool_at( size_type id, size_type index ) const noexcept
+  {
+    size_type target, length;
+    const size_type offset = slot(id, reference_size);
+    if(!offset || !load_reference(offset, 1, target, length) || index >= length) return false;
+
+    return m_data[target + index] != 0;
+  }
+
+  int FixedView::get_int_at( size_type id, size_type index ) const noexcept
+  {
+    size_type target, length;
+    const size_type offset = slot(id, reference_size);
+    if(!offset || !load_reference(offset, sizeof(std::int32_t), target, length) || index >= length) return 0;
+
+    return static_cast<int>(load<std::int32_t>(target + index * sizeof(std::int32_t)));
+  }
+
+  float FixedView::get_float_at( size_type id, size_type index ) const noexcept
+  {
+    size_type target, length;
+    const size_type offset = slot(id, reference_size);
+    if(!offset || !load_reference(offset, sizeof(float), target, length) || index >= length) return 0.0f;
+
+    return load<float>(target + index * sizeof(float));
+  }
+
+  std::string_view FixedView::get_string_at( size_type id, size_type index ) const noexcept
+  {
+    size_type target, length;
+    const size_type offset = slot(id, reference_size);
+    if(!offset || !load_reference(offset, reference_size, target, length) || index >= length){
+      return std::string_view();
+    }
+
+    size_type characters, count;
+    if(!load_reference(target + index * reference_size, 1, characters, count)){
+      return std::string_view();
+    }
+    return std::string_view(m_data + characters, count);
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool FixedView::load_reference( size_type offset,
+                                  size_type width,
+                                  size_type& target,
+                                  size_type& length ) const noexcept
+  {
+    target = load<std::uint32_t>(offset);
+    length = load<std::uint32_t>(offset + sizeof(std::uint32_t));
+
+    // Lengths are at most 32 bits, so this cannot overflow
+    return target <= m_size && length * width <= m_size - target;
+  }
+
+} // namespace serial
@@ -0,0 +1,251 @@
+/**
+ * \file KeyTable.cpp
+ *
+ * Implementation of the process-wide \c KeyTable that interns object
+ * keys, with lock-free lookups
+ */
+#include <KeyTable.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace serial{
+
+  //--------------------------------------------------------------------------
+  // Private Types
+  //--------------------------------------------------------------------------
+
+  /// \brief An interned key and its symbol, which point at each other
+  struct key_entry
+  {
+    std::string        name;
+    detail::key_symbol symbol;
+  };
+
+  /// \brief An open-addressed index of the symbols of a shard. Slots are
+  ///        only ever filled, so a reader probing concurrently with an
+  ///        insertion either sees the new symbol or an empty slot
+  struct key_index
+  {
+    explicit key_index( std::size_t capacity )
+      : mask(capacity - 1),
+        slots(new std::atomic<const detail::key_symbol*>[capacity])
+    {
+      for(std::size_t i = 0; i < capacity; ++i){
+        slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    std::size_t                                             mask;
+    std::unique_ptr<std::atomic<const detail::key_symbol*>[]> slots;
+  };
+
+  /// \brief The interned keys whose hash selects this shard. Entries are
+  ///        never moved, so each symbol points at the key of its own entry
+  ///
+  /// A full index is replaced by one twice the size; the old one is kept,
+  /// since readers may still be probing it, which at most doubles the
+  /// memory of the index.
+  struct key_shard
+  {
+    std::mutex                              mutex;   ///< serializes interning
+    std::atomic<const key_index*>           index;   ///< the published index
+    std::vector<std::unique_ptr<key_index>> indices; ///< every index, in order
+    std::deque<key_entry>                   entries; ///< the interned keys
+  };
+
+  struct key_table
+  {
+    static constexpr std::size_t shards        = 16;
+    static constexpr std::size_t initial_slots = 64;
+
+    key_shard                  shard[shards];
+    std::atomic<std::uint32_t> next_id;
+    std::atomic<std::size_t>   bytes;
+    std::atomic<std::size_t>   limit;
+  };
+
+  constexpr std::size_t key_table::shards;
+  constexpr std::size_t key_table::initial_slots;
+
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  /// \brief Gets the table, which is never destroyed so that handles stay
+  ///        valid during static destruction
+  static key_table& table()
+  {
+    static key_table* s_table = []{
+      key_table* result = new key_table;
+      for(auto& s : result->shard){
+        s.indices.emplace_back(new key_index(key_table::initial_slots));
+        s.index.store(s.indices.back().get(), std::memory_order_relaxed);
+      }
+      result->next_id.store(1, std::memory_order_relaxed);
+      result->bytes.store(0, std::memory_order_relaxed);
+      result->limit.store(std::size_t(16) << 20, std::memory_order_relaxed);
+      return result;
+    }();
+    return *s_table;
+  }
+
+  static std::string s_empty;
+
+  /// \brief Gets the shard of a key with the hash \p hash
+  static key_shard& shard_of( key_table& t, std::size_t hash )
+  {
+    return t.shard[hash % key_table::shards];
+  }
+
+  /// \brief Gets the first 8 bytes of \p name, big-endian and zero padded,
+  ///        so that prefixes order like the keys they start
+  static std::uint64_t prefix_of( const std::string& name )
+  {
+    std::uint64_t result = 0;
+    for(std::size_t i = 0; i < 8; ++i){
+      const unsigned char c = (i < name.size()) ? static_cast<unsigned char>(name[i]) : 0;
+      result = (result << 8) | c;
+    }
+    return result;
+  }
+
+  /// \brief Probes \p index for \p name; safe to call without the lock
+  static const detail::key_symbol* probe( const key_index& index,
+                                          const std::string& name,
+                                          std::size_t hash )
+  {
+    // The low bits of the hash chose the shard, so they are skipped here
+    for(std::size_t i = (hash / key_table::shards) & index.mask; ; i = (i + 1) & index.mask){
+      const detail::key_symbol* symbol = index.slots[i].load(std::memory_order_acquire);
+      if(!symbol) return nullptr;
+      if(symbol->hash == hash && *symbol->name == name) return symbol;
+    }
+  }
+
+  /// \brief Stores \p symbol in the first empty slot of its probe sequence
+  static void place( key_index& index, const detail::key_symbol* symbol )
+  {
+    std::size_t i = (symbol->hash / key_table::shards) & index.mask;
+    while(index.slots[i].load(std::memory_order_relaxed)){
+      i = (i + 1) & index.mask;
+    }
+    index.slots[i].store(symbol, std::memory_order_release);
+  }
+
+  //--------------------------------------------------------------------------
+  // key_handle
+  //--------------------------------------------------------------------------
+
+  const std::string& key_handle::name() const noexcept
+  {
+    return m_symbol ? *m_symbol->name : s_empty;
+  }
+
+  int key_handle::compare_names( const key_handle& other ) const noexcept
+  {
+    const int result = name().compare(other.name());
+    if(result) return (result < 0) ? -1 : 1;
+
+    // Only an invalid handle shares its (empty) name with another handle
+    return (m_id < other.m_id) ? -1 : 1;
+  }
+
+  //--------------------------------------------------------------------------
+  // KeyTable
+  //--------------------------------------------------------------------------
+
+  key_handle KeyTable::intern( const std::string& name )
+  {
+    return intern(name, false);
+  }
+
+  key_handle KeyTable::try_intern( const std::string& name )
+  {
+    return intern(name, true);
+  }
+
+  key_handle KeyTable::find( const std::string& name )
+  {
+    key_table&        t    = table();
+    const std::size_t hash = std::hash<std::string>()(name);
+    key_shard&        s    = shard_of(t, hash);
+
+    const detail::key_symbol* symbol = probe(*s.index.load(std::memory_order_acquire), name, hash);
+    return symbol ? key_handle(symbol) : key_handle();
+  }
+
+  KeyTable::size_type KeyTable::size()
+  {
+    key_table& t = table();
+    return t.next_id.load(std::memory_order_relaxed) - 1;
+  }
+
+  KeyTable::size_type KeyTable::bytes()
+  {
+    return table().bytes.load(std::memory_order_relaxed);
+  }
+
+  KeyTable::size_type KeyTable::limit()
+  {
+    return table().limit.load(std::memory_order_relaxed);
+  }
+
+  void KeyTable::set_limit( size_type bytes )
+  {
+    table().limit.store(bytes, std::memory_order_relaxed);
+  }
+
+  //--------------------------------------------------------------------------
+  // Private Static Functions
+  //--------------------------------------------------------------------------
+
+  key_handle KeyTable::intern( const std::string& name, bool bounded )
+  {
+    key_table&        t    = table();
+    const std::size_t hash = std::hash<std::string>()(name);
+    key_shard&        s    = shard_of(t, hash);
+
+    // Most keys are already interned, which needs no lock
+    const detail::key_symbol* symbol = probe(*s.index.load(std::memory_order_acquire), name, hash);
+    if(symbol) return key_handle(symbol);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    key_index* index = s.indices.back().get();
+    symbol = probe(*index, name, hash);
+    if(symbol) return key_handle(symbol);
+
+    const std::size_t cost = sizeof(key_entry) + name.size();
+    const std::size_t used = t.bytes.fetch_add(cost, std::memory_order_relaxed) + cost;
+    if(bounded && used > t.limit.load(std::memory_order_relaxed)){
+      t.bytes.fetch_sub(cost, std::memory_order_relaxed);
+      return key_handle();
+    }
+
+    s.entries.push_back(key_entry{name, detail::key_symbol()});
+    key_entry& entry = s.entries.back();
+    entry.symbol.name   = &entry.name;
+    entry.symbol.hash   = hash;
+    entry.symbol.prefix = prefix_of(name);
+    entry.symbol.id     = t.next_id.fetch_add(1, std::memory_order_relaxed);
+
+    // Keep the index at most half full, so that probes stay short
+    if(2 * s.entries.size() > index->mask + 1){
+      std::unique_ptr<key_index> grown(new key_index(2 * (index->mask + 1)));
+      for(const auto& x : s.entries){
+        place(*grown, &x.symbol);
+      }
+      s.index.store(grown.get(), std::memory_order_release);
+      s.indices.push_back(std::move(grown));
+    }else{
+      place(*index, &entry.symbol);
+    }
+    return key_handle(&entry.symbol);
+  }
+
+} // namespace serial
@@ -0,0 +1,95 @@
+/**
+ * \file MappedFile.cpp
+ *
+ * Implementation of \c MappedFile, which maps a file into memory
+ * where the platform allows it and reads it otherwise
+ */
+#include <MappedFile.hpp>
+
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# define SERIAL_MAPPEDFILE_POSIX 1
+#else
+# define SERIAL_MAPPEDFILE_POSIX 0
+#endif
+
+namespace serial{
+
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  /// \brief Reads the whole file at \p path into \p buffer
+  ///
+  /// \return \c true on success
+  static bool read_file( const std::string& path, std::vector<char>& buffer )
+  {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if(!file) return false;
+
+    bool result = false;
+    if(std::fseek(file, 0, SEEK_END) == 0){
+      const long size = std::ftell(file);
+      if(size >= 0 && std::fseek(file, 0, SEEK_SET) == 0){
+        buffer.resize(static_cast<std::size_t>(size));
+        result = std::fread(buffer.data(), 1, buffer.size(), file) == buffer.size();
+      }
+    }
+    std::fclose(file);
+    return result;
+  }
+
+  //--------------------------------------------------------------------------
+  // Constructor / Destructor
+  //--------------------------------------------------------------------------
+
+  MappedFile::MappedFile( const std::string& path )
+    : m_data(nullptr),
+      m_size(0),
+      m_open(false),
+      m_mapped(false)
+  {
+#if SERIAL_MAPPEDFILE_POSIX
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return;
+
+    struct stat info;
+    if(::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0){
+      void* data = ::mmap(nullptr, static_cast<std::size_t>(info.st_size),
+                          PROT_READ, MAP_PRIVATE, fd, 0);
+      if(data != MAP_FAILED){
+        ::madvise(data, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+
+        m_data   = static_cast<const char*>(data);
+        m_size   = static_cast<size_type>(info.st_size);
+        m_open   = true;
+        m_mapped = true;
+      }
+    }
+    ::close(fd);
+    if(m_open) return;
+#endif
+
+    // Empty files, and files that cannot be mapped, are read instead
+    if(read_file(path, m_buffer)){
+      m_data = m_buffer.data();
+      m_size = m_buffer.size();
+      m_open = true;
+    }
+  }
+
+  MappedFile::~MappedFile()
+  {
+#if SERIAL_MAPPEDFILE_POSIX
+    if(m_mapped){
+      ::munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+  }
+
+} // namespace serial
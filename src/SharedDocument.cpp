@@ -0,0 +1,168 @@
+/**
+ * \file SharedDocument.cpp
+ *
+ * Implementation of \c SharedDocument: lock-free reads, atomic
+ * replacement and epoch-based reclamation of replaced trees
+ */
+#include <SharedDocument.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace serial{
+
+  //--------------------------------------------------------------------------
+  // Static Members
+  //--------------------------------------------------------------------------
+
+  /// The global epoch, shared by every document. 0 marks an idle reader
+  static std::atomic<std::uint64_t> s_epoch(1);
+
+  /// Every reader record ever created; records are never freed
+  static std::atomic<detail::reader_record*> s_records(nullptr);
+
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  /// \brief Claims a record left by an exited thread, or registers a new one
+  static detail::reader_record* acquire_record()
+  {
+    for(auto* record = s_records.load(std::memory_order_acquire); record; record = record->next){
+      bool expected = false;
+      if(!record->in_use.load(std::memory_order_relaxed) &&
+         record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)){
+        return record;
+      }
+    }
+
+    auto* record = new detail::reader_record;
+    record->epoch.store(0, std::memory_order_relaxed);
+    record->in_use.store(true, std::memory_order_relaxed);
+    record->depth = 0;
+    record->next  = s_records.load(std::memory_order_relaxed);
+    while(!s_records.compare_exchange_weak(record->next, record,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)){
+    }
+    return record;
+  }
+
+  /// \brief Owns the record of a thread, returning it when the thread exits
+  struct thread_record
+  {
+    detail::reader_record* record = acquire_record();
+
+    ~thread_record()
+    {
+      record->in_use.store(false, std::memory_order_release);
+    }
+  };
+
+  static detail::reader_record* current_record()
+  {
+    static thread_local thread_record s_record;
+
+    return s_record.record;
+  }
+
+  //--------------------------------------------------------------------------
+  // snapshot
+  //--------------------------------------------------------------------------
+
+  SharedDocument::snapshot::~snapshot()
+  {
+    // Going idle must not be reordered before the reads of the document
+    if(m_record && --m_record->depth == 0){
+      m_record->epoch.store(0, std::memory_order_release);
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // Constructors / Destructor
+  //--------------------------------------------------------------------------
+
+  SharedDocument::SharedDocument( DataValue value )
+    : m_current(new DataValue(std::move(value)))
+  {
+
+  }
+
+  SharedDocument::~SharedDocument()
+  {
+    delete m_current.load(std::memory_order_relaxed);
+    for(const auto& x : m_retired){
+      delete x.second;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // Reading
+  //--------------------------------------------------------------------------
+
+  SharedDocument::snapshot SharedDocument::read() const
+  {
+    detail::reader_record* record = current_record();
+
+    // The epoch is announced before the document is loaded, so a writer
+    // that retires the loaded version sees this reader as active
+    if(record->depth++ == 0){
+      record->epoch.store(s_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+    return snapshot(record, m_current.load(std::memory_order_seq_cst));
+  }
+
+  //--------------------------------------------------------------------------
+  // Writing
+  //--------------------------------------------------------------------------
+
+  void SharedDocument::publish( DataValue value )
+  {
+    const DataValue* next = new DataValue(std::move(value));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Readers that can see 'previous' announced an epoch no later than the
+    // one it is retired in; later readers load 'next'
+    const DataValue* previous = m_current.exchange(next, std::memory_order_seq_cst);
+    m_retired.emplace_back(s_epoch.fetch_add(1, std::memory_order_seq_cst), previous);
+
+    reclaim_locked();
+  }
+
+  SharedDocument::size_type SharedDocument::reclaim()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return reclaim_locked();
+  }
+
+  //--------------------------------------------------------------------------
+  // Private Member Functions
+  //--------------------------------------------------------------------------
+
+  SharedDocument::size_type SharedDocument::reclaim_locked()
+  {
+    if(m_retired.empty()) return 0;
+
+    std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+    for(auto* record = s_records.load(std::memory_order_acquire); record; record = record->next){
+      const std::uint64_t epoch = record->epoch.load(std::memory_order_seq_cst);
+      if(epoch != 0){
+        oldest = std::min(oldest, epoch);
+      }
+    }
+
+    // Versions retired before the oldest announced epoch are unreachable
+    const auto last = std::partition(m_retired.begin(), m_retired.end(), [&]( const retired_value& x ){
+      return x.first >= oldest;
+    });
+    for(auto it = last; it != m_retired.end(); ++it){
+      delete it->second;
+    }
+    m_retired.erase(last, m_retired.end());
+
+    return m_retired.size();
+  }
+
+} // namespace serial
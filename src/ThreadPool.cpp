@@ -0,0 +1,202 @@
+/**
+ * \file ThreadPool.cpp
+ *
+ * Implementation of the work-stealing \c ThreadPool shared by the parallel
+ * algorithms
+ */
+#include <ThreadPool.hpp>
+
+#include <algorithm>
+
+namespace serial{
+
+  //--------------------------------------------------------------------------
+  // Static Members
+  //--------------------------------------------------------------------------
+
+  /// The pool that the calling thread is a worker of, if any
+  static thread_local const ThreadPool* t_pool = nullptr;
+
+  /// The index of the calling worker in 't_pool'
+  static thread_local std::size_t t_index = 0;
+
+  //--------------------------------------------------------------------------
+  // Constructor / Destructor
+  //--------------------------------------------------------------------------
+
+  ThreadPool::ThreadPool( size_type threads )
+    : m_queued(0),
+      m_stop(false)
+  {
+    // The waiting thread is one of the threads executing tasks
+    const size_type workers = std::max<size_type>(threads, 1) - 1;
+
+    for(size_type i = 0; i <= workers; ++i){
+      m_queues.emplace_back(new task_queue);
+    }
+
+    m_workers.reserve(workers);
+    for(size_type i = 0; i < workers; ++i){
+      m_workers.emplace_back([this, i]{ worker(i); });
+    }
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wakeup.notify_all();
+
+    for(auto& x : m_workers){
+      x.join();
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // Observers
+  //--------------------------------------------------------------------------
+
+  ThreadPool& ThreadPool::instance()
+  {
+    static ThreadPool s_pool;
+
+    return s_pool;
+  }
+
+  ThreadPool::size_type ThreadPool::size() const noexcept
+  {
+    return m_workers.size() + 1;
+  }
+
+  //--------------------------------------------------------------------------
+  // Private Member Functions
+  //--------------------------------------------------------------------------
+
+  void ThreadPool::submit( task_group& group, std::function<void()> function )
+  {
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+
+    task_queue& queue = *m_queues[current_queue()];
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(task{std::move(function), &group});
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+
+    // Only wake a worker if one may be asleep
+    if(!m_workers.empty()){
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_wakeup.notify_one();
+    }
+  }
+
+  void ThreadPool::fail( task_group& group ) noexcept
+  {
+    if(!group.failed.exchange(true, std::memory_order_relaxed)){
+      group.error = std::current_exception();
+    }
+  }
+
+  void ThreadPool::wait( task_group& group )
+  {
+    const size_type index = current_queue();
+
+    while(group.pending.load(std::memory_order_acquire) != 0){
+      if(run_one(index)) continue;
+
+      // The remaining tasks are running elsewhere; sleep until they finish
+      // or until more work is queued
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeup.wait(lock, [this, &group]{
+        return group.pending.load(std::memory_order_acquire) == 0 ||
+               m_queued.load(std::memory_order_acquire) != 0;
+      });
+    }
+
+    if(group.error){
+      std::rethrow_exception(group.error);
+    }
+  }
+
+  void ThreadPool::finish( task_group& group )
+  {
+    // Locking orders the wakeup after a waiter's check of 'pending'
+    if(group.pending.fetch_sub(1, std::memory_order_acq_rel) == 1){
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_wakeup.notify_all();
+    }
+  }
+
+  bool ThreadPool::run_one( size_type index )
+  {
+    task current;
+    bool found = false;
+
+    // The own queue is worked from the back; others are stolen from the front
+    {
+      task_queue& queue = *m_queues[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if(!queue.tasks.empty()){
+        current = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        found = true;
+      }
+    }
+
+    for(size_type i = 1; !found && i < m_queues.size(); ++i){
+      task_queue& queue = *m_queues[(index + i) % m_queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if(!queue.tasks.empty()){
+        current = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        found = true;
+      }
+    }
+
+    if(!found) return false;
+
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+
+    // The task is done however it exits, so that its loop never waits on it
+    struct finisher
+    {
+      ThreadPool* pool;
+      task_group* group;
+      ~finisher(){ pool->finish(*group); }
+    } done{this, current.group};
+
+    // Once a task has failed, the rest of its loop is skipped
+    if(!current.group->failed.load(std::memory_order_relaxed)){
+      try{
+        current.function();
+      }catch(...){
+        fail(*current.group);
+      }
+    }
+    return true;
+  }
+
+  ThreadPool::size_type ThreadPool::current_queue() const noexcept
+  {
+    return (t_pool == this) ? t_index : m_workers.size();
+  }
+
+  void ThreadPool::worker( size_type index )
+  {
+    t_pool  = this;
+    t_index = index;
+
+    while(true){
+      if(run_one(index)) continue;
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeup.wait(lock, [this]{
+        return m_stop || m_queued.load(std::memory_order_acquire) != 0;
+      });
+      if(m_stop) return;
+    }
+  }
+
+} // namespace serial
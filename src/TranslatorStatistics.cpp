@@ -0,0 +1,185 @@
+/**
+ * \file TranslatorStatistics.cpp
+ *
+ * Implementation of the per-thread counters and latency histogram
+ * collected by \c DataTranslator
+ */
+#include <TranslatorStatistics.hpp>
+
+#include <algorithm>
+
+namespace serial{
+
+  //--------------------------------------------------------------------------
+  // Static Constants
+  //--------------------------------------------------------------------------
+
+  constexpr std::size_t translator_statistics::latency_buckets;
+  constexpr std::size_t detail::TranslatorCounters::stripes;
+
+  /// Number of linear sub-buckets per power of two, as a power of two
+  static constexpr unsigned sub_bucket_bits = 2;
+  static constexpr unsigned sub_buckets     = 1u << sub_bucket_bits;
+
+  //--------------------------------------------------------------------------
+  // Static Functions
+  //--------------------------------------------------------------------------
+
+  /// \brief Gets the index of the most significant set bit of \p x (x > 0)
+  static inline unsigned most_significant_bit( std::uint64_t x ) noexcept
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(x));
+#else
+    unsigned result = 0;
+    while(x >>= 1){
+      ++result;
+    }
+    return result;
+#endif
+  }
+
+  /// \brief Gets the stripe used by the calling thread
+  static std::size_t current_stripe() noexcept
+  {
+    static std::atomic<std::size_t> s_next(0);
+    static thread_local std::size_t s_stripe = s_next.fetch_add(1, std::memory_order_relaxed);
+
+    return s_stripe;
+  }
+
+  //--------------------------------------------------------------------------
+  // translator_statistics
+  //--------------------------------------------------------------------------
+
+  std::size_t translator_statistics::latency_bucket( std::uint64_t nanoseconds ) noexcept
+  {
+    if(nanoseconds < sub_buckets){
+      return static_cast<std::size_t>(nanoseconds);
+    }
+
+    const unsigned    msb    = most_significant_bit(nanoseconds);
+    const unsigned    sub    = static_cast<unsigned>(nanoseconds >> (msb - sub_bucket_bits)) & (sub_buckets - 1);
+    const std::size_t bucket = (msb - sub_bucket_bits + 1) * sub_buckets + sub;
+
+    return std::min(bucket, latency_buckets - 1);
+  }
+
+  std::uint64_t translator_statistics::latency_upper_bound( std::size_t bucket ) noexcept
+  {
+    if(bucket < sub_buckets){
+      return bucket;
+    }
+
+    const unsigned shift = static_cast<unsigned>(bucket / sub_buckets) - 1;
+    const std::uint64_t lower = static_cast<std::uint64_t>(sub_buckets + bucket % sub_buckets) << shift;
+    return lower + (std::uint64_t(1) << shift) - 1;
+  }
+
+  std::uint64_t translator_statistics::latency_percentile( double percentile ) const noexcept
+  {
+    std::uint64_t total = 0;
+    for(std::uint64_t x : latency){
+      total += x;
+    }
+    if(total == 0) return 0;
+
+    const double        clamped = std::min(std::max(percentile, 0.0), 100.0);
+    const std::uint64_t target  = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(total * clamped / 100.0 + 0.5));
+
+    std::uint64_t seen = 0;
+    for(std::size_t i = 0; i < latency_buckets; ++i){
+      seen += latency[i];
+      if(seen >= target) return latency_upper_bound(i);
+    }
+    return latency_upper_bound(latency_buckets - 1);
+  }
+
+  namespace detail{
+
+    //------------------------------------------------------------------------
+    // TranslatorCounters
+    //------------------------------------------------------------------------
+
+    TranslatorCounters::TranslatorCounters() noexcept
+    {
+      reset();
+    }
+
+    TranslatorCounters::TranslatorCounters( const TranslatorCounters& other )
+      : m_bindings(other.m_bindings)
+    {
+      reset();
+    }
+
+    TranslatorCounters& TranslatorCounters::operator=( const TranslatorCounters& other )
+    {
+      m_bindings = other.m_bindings;
+      return (*this);
+    }
+
+    void TranslatorCounters::bind( const std::string& name )
+    {
+      m_bindings.insert(name);
+    }
+
+    bool TranslatorCounters::is_bound( const std::string& name ) const
+    {
+      return m_bindings.count(name) != 0;
+    }
+
+    void TranslatorCounters::record( const sample_type& sample ) noexcept
+    {
+      const auto elapsed = std::chrono::steady_clock::now() - sample.m_start;
+      const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+      // Only this thread writes to its stripe (barring more threads than
+      // stripes), so relaxed ordering suffices
+      stripe& s = m_stripes[current_stripe() % stripes];
+      s.translations.fetch_add(1, std::memory_order_relaxed);
+      s.matched.fetch_add(sample.m_matched, std::memory_order_relaxed);
+      s.unknown_keys.fetch_add(sample.m_unknown_keys, std::memory_order_relaxed);
+      s.type_mismatches.fetch_add(sample.m_type_mismatches, std::memory_order_relaxed);
+      s.bytes_copied.fetch_add(sample.m_bytes_copied, std::memory_order_relaxed);
+
+      const std::size_t bucket = translator_statistics::latency_bucket(
+        static_cast<std::uint64_t>(std::max<decltype(nanoseconds)>(nanoseconds, 0))
+      );
+      s.latency[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    translator_statistics TranslatorCounters::aggregate() const noexcept
+    {
+      translator_statistics result = translator_statistics();
+
+      for(const stripe& s : m_stripes){
+        result.translations    += s.translations.load(std::memory_order_relaxed);
+        result.matched         += s.matched.load(std::memory_order_relaxed);
+        result.unknown_keys    += s.unknown_keys.load(std::memory_order_relaxed);
+        result.type_mismatches += s.type_mismatches.load(std::memory_order_relaxed);
+        result.bytes_copied    += s.bytes_copied.load(std::memory_order_relaxed);
+
+        for(std::size_t i = 0; i < translator_statistics::latency_buckets; ++i){
+          result.latency[i] += s.latency[i].load(std::memory_order_relaxed);
+        }
+      }
+      return result;
+    }
+
+    void TranslatorCounters::reset() noexcept
+    {
+      for(stripe& s : m_stripes){
+        s.translations.store(0, std::memory_order_relaxed);
+        s.matched.store(0, std::memory_order_relaxed);
+        s.unknown_keys.store(0, std::memory_order_relaxed);
+        s.type_mismatches.store(0, std::memory_order_relaxed);
+        s.bytes_copied.store(0, std::memory_order_relaxed);
+
+        for(auto& x : s.latency){
+          x.store(0, std::memory_order_relaxed);
+        }
+      }
+    }
+
+  } // namespace detail
+} // namespace serial
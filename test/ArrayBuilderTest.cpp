@@ -0,0 +1,73 @@
+/**
+ * \file ArrayBuilderTest.cpp
+ *
+ * Checks that elements appended from many threads all reach the finished
+ * array, in order per thread, and that a finished builder can be reused
+ *
+ */
+#include "Check.hpp"
+
+#include <ArrayBuilder.hpp>
+#include <ThreadPool.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace serial{
+namespace test{
+
+  void array_builder()
+  {
+    const std::int32_t threads  = 4;
+    const std::int32_t elements = 5000;
+
+    // Appending to another builder in between must not mix up the shards
+    ArrayBuilder builder, other;
+    for(int round = 0; round < 3; ++round){
+      std::vector<std::thread> workers;
+      for(std::int32_t t = 0; t < threads; ++t){
+        workers.emplace_back([&, t]{
+          for(std::int32_t i = 0; i < elements; ++i){
+            builder.add_member(DataValue(t * elements + i));
+            if(i % 7 == 0) other.add_member(DataValue(i));
+          }
+        });
+      }
+      for(auto& x : workers) x.join();
+
+      SERIAL_CHECK(builder.shards() == static_cast<std::size_t>(threads));
+      const DataValue result = builder.finish();
+      SERIAL_CHECK(builder.shards() == 0);
+      SERIAL_CHECK(result.size() == static_cast<std::size_t>(threads * elements));
+      SERIAL_CHECK(other.finish().size() == static_cast<std::size_t>(threads * (elements / 7 + 1)));
+
+      std::vector<std::int32_t> last(threads, -1);
+      std::vector<bool> seen(threads * elements, false);
+      for(std::size_t i = 0; i < result.size(); ++i){
+        const std::int32_t x = result.at(i).as_int();
+        SERIAL_CHECK(x >= 0 && x < threads * elements && !seen[x]);
+        if(x < 0 || x >= threads * elements) continue;
+
+        SERIAL_CHECK(x % elements > last[x / elements]);
+        last[x / elements] = x % elements;
+        seen[x] = true;
+      }
+    }
+
+    ThreadPool pool(4);
+    ArrayBuilder pooled;
+    pool.parallel_for(0, 100000, 1000, [&]( std::size_t first, std::size_t last ){
+      for(std::size_t i = first; i < last; ++i) pooled.add_member(DataValue(static_cast<std::int32_t>(i)));
+    });
+    const DataValue result = pooled.finish();
+    std::int64_t sum = 0;
+    for(std::size_t i = 0; i < result.size(); ++i) sum += result.at(i).as_int();
+    SERIAL_CHECK(result.size() == 100000 && sum == std::int64_t(99999) * 100000 / 2);
+
+    const DataValue empty = ArrayBuilder().finish();
+    SERIAL_CHECK(empty.is_array() && empty.size() == 0);
+  }
+
+} // namespace test
+} // namespace serial
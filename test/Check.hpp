@@ -0,0 +1,45 @@
+/**
+ * \file Check.hpp
+ *
+ * A minimal check macro for the tests, which keeps running after a failed
+ * check and reports every failure
+ *
+ */
+#ifndef SERIAL_TEST_CHECK_HPP_
+#define SERIAL_TEST_CHECK_HPP_
+
+#include <atomic>
+#include <cstddef>
+
+namespace serial{
+namespace test{
+
+  /// \brief The number of checks that failed, on any thread
+  extern std::atomic<std::size_t> failures;
+
+  /// \brief Reports the failed check \p expression at \p file and \p line
+  void fail( const char* file, int line, const char* expression );
+
+  // Tests, each run by name from main.cpp
+  void shared_document();
+  void key_table();
+  void schema();
+  void thread_pool();
+  void array_builder();
+  void patch_round_trip();
+  void deep_patch();
+  void splice();
+  void translation_cache();
+  void number_conversion();
+  void range_flags();
+  void fixed_view();
+
+} // namespace test
+} // namespace serial
+
+/// \brief Checks that \p expression holds, reporting it otherwise; unlike
+///        \c assert, checks are never compiled out
+#define SERIAL_CHECK(expression) \
+  ((expression) ? (void)0 : ::serial::test::fail(__FILE__, __LINE__, #expression))
+
+#endif /* SERIAL_TEST_CHECK_HPP_ */
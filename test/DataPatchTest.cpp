@@ -0,0 +1,113 @@
+/**
+ * \file DataPatchTest.cpp
+ *
+ * Checks that applying the diff of two trees to the first yields the
+ * second, over seeded random pairs and a chain too deep to recurse on
+ *
+ */
+#include "Check.hpp"
+
+#include <DataPatch.hpp>
+
+#include <random>
+#include <string>
+
+namespace serial{
+namespace test{
+
+  namespace{
+
+    /// \brief Generates a random tree at most \p depth levels deep
+    DataValue generate( std::mt19937& random, int depth )
+    {
+      switch(depth == 0 ? random() % 2 : random() % 4){
+      case 0:
+        return DataValue(static_cast<std::int32_t>(random() % 5));
+      case 1:{
+        DataValue result;
+        result.set_string(std::string(1, static_cast<char>('a' + random() % 3)));
+        return result;
+      }
+      case 2:{
+        DataValue result(DataValue::type_array);
+        for(auto n = random() % 5; n > 0; --n) result.add_member(generate(random, depth - 1));
+        return result;
+      }
+      default:{
+        DataValue result(DataValue::type_object);
+        for(auto n = random() % 5; n > 0; --n){
+          result.add_member(std::string(1, static_cast<char>('k' + random() % 6)), generate(random, depth - 1));
+        }
+        return result;
+      }
+      }
+    }
+
+    /// \brief Copies \p value with random members and elements replaced,
+    ///        removed or added
+    DataValue mutate( std::mt19937& random, const DataValue& value, int depth )
+    {
+      if(depth == 0 || random() % 4 == 0) return generate(random, depth);
+
+      if(value.is_array()){
+        DataValue result(DataValue::type_array);
+        for(const auto& x : value.elements()){
+          if(random() % 5) result.add_member(random() % 3 ? x : mutate(random, x, depth - 1));
+          if(random() % 6 == 0) result.add_member(generate(random, depth - 1));
+        }
+        return result;
+      }
+      if(value.is_object()){
+        DataValue result(DataValue::type_object);
+        for(auto x : value.members()){
+          if(random() % 5) result.add_member(x.key, random() % 3 ? DataValue(x.value) : mutate(random, x.value, depth - 1));
+        }
+        if(random() % 3 == 0){
+          result.add_member(std::string(1, static_cast<char>('k' + random() % 6)), generate(random, depth - 1));
+        }
+        return result;
+      }
+      return generate(random, depth);
+    }
+
+  } // anonymous namespace
+
+  void patch_round_trip()
+  {
+    std::mt19937 random(42);
+    for(int i = 0; i < 5000; ++i){
+      const DataValue from = generate(random, 4);
+      const DataValue to   = mutate(random, from, 4);
+
+      DataValue patched = from;
+      SERIAL_CHECK(apply_patch(patched, diff(from, to)));
+      SERIAL_CHECK(patched.equals(to));
+      SERIAL_CHECK(diff(to, to).size() == 0);
+    }
+  }
+
+  void deep_patch()
+  {
+    // Nested far deeper than the call stack allows recursing
+    DataValue from(DataValue::type_array), to(DataValue::type_array);
+    DataValue* x = &from;
+    DataValue* y = &to;
+    for(int i = 0; i < 100000; ++i){
+      x->add_member(DataValue(DataValue::type_array));
+      y->add_member(DataValue(DataValue::type_array));
+      x = &x->at(0);
+      y = &y->at(0);
+    }
+    x->add_member(DataValue(1));
+    y->add_member(DataValue(2));
+
+    SERIAL_CHECK(!from.equals(to) && from.compare(to) < 0 && to.compare(from) > 0);
+    SERIAL_CHECK(from.hash() == from.clone().hash());
+
+    DataValue patched = from;
+    SERIAL_CHECK(apply_patch(patched, diff(from, to)));
+    SERIAL_CHECK(patched.equals(to));
+  }
+
+} // namespace test
+} // namespace serial
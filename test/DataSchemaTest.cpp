@@ -0,0 +1,103 @@
+/**
+ * \file DataSchemaTest.cpp
+ *
+ * Checks that schemas validate the keywords they support, and that a
+ * validation keyword that is not supported fails the compilation rather
+ * than being skipped
+ *
+ */
+#include "Check.hpp"
+
+#include <DataSchema.hpp>
+
+#include <string>
+
+namespace serial{
+namespace test{
+
+  namespace{
+
+    /// \brief Makes a string value
+    DataValue make_string( const std::string& str )
+    {
+      DataValue result;
+      result.set_string(str);
+      return result;
+    }
+
+    /// \brief Makes the schema { "type": "object", "properties":
+    ///        { "id": { "type": "integer", "minimum": 0 } }, "required":
+    ///        [ "id" ], "additionalProperties": false }
+    DataValue make_schema()
+    {
+      DataValue id(DataValue::type_object);
+      id.add_member("type", make_string("integer"));
+      id.add_member("minimum", DataValue(std::int32_t(0)));
+
+      DataValue properties(DataValue::type_object);
+      properties.add_member("id", id);
+
+      DataValue required(DataValue::type_array);
+      required.add_member(make_string("id"));
+
+      DataValue schema(DataValue::type_object);
+      schema.add_member("type", make_string("object"));
+      schema.add_member("properties", properties);
+      schema.add_member("required", required);
+      schema.add_member("additionalProperties", DataValue(false));
+      schema.add_member("title", make_string("an annotation"));
+      return schema;
+    }
+
+  } // anonymous namespace
+
+  void schema()
+  {
+    DataSchema schema;
+    SERIAL_CHECK(schema.compile(make_schema()));
+
+    DataValue value(DataValue::type_object);
+    value.add_member("id", DataValue(std::int32_t(4)));
+    SERIAL_CHECK(schema.validate(value));
+
+    value.at(std::string("id")).set_int(-1);
+    SERIAL_CHECK(!schema.validate(value));
+
+    value.at(std::string("id")).set_int(4);
+    value.add_member("name", make_string("extra"));
+    SERIAL_CHECK(!schema.validate(value));
+
+    SERIAL_CHECK(!schema.validate(DataValue(DataValue::type_object)));
+    SERIAL_CHECK(!schema.validate(DataValue(std::int32_t(4))));
+
+    // Every unsupported validation keyword fails, keeping the last program
+    const char* const unsupported[] = {
+      "multipleOf", "pattern", "format", "const", "uniqueItems", "contains",
+      "minProperties", "maxProperties", "patternProperties", "anyOf",
+      "allOf", "oneOf", "not", "if", "$ref",
+    };
+    for(const char* name : unsupported){
+      DataValue unknown = make_schema();
+      unknown.add_member(name, DataValue(true));
+      SERIAL_CHECK(!schema.compile(unknown));
+
+      // Nested schemas are checked too
+      DataValue nested = make_schema();
+      nested.at(std::string("properties")).at(std::string("id")).add_member(name, DataValue(true));
+      SERIAL_CHECK(!schema.compile(nested));
+    }
+    SERIAL_CHECK(!schema.validate(DataValue(std::int32_t(4))));
+
+    // Malformed keywords fail likewise
+    DataValue tuple = make_schema();
+    tuple.add_member("items", DataValue(DataValue::type_array));
+    SERIAL_CHECK(!schema.compile(tuple));
+
+    DataValue open = make_schema();
+    open.at(std::string("additionalProperties")).set_bool(true);
+    SERIAL_CHECK(schema.compile(open));
+    SERIAL_CHECK(schema.validate(value));
+  }
+
+} // namespace test
+} // namespace serial
@@ -0,0 +1,257 @@
+/**
+ * \file DataValueTest.cpp
+ *
+ * Checks the removal and splicing of members and elements, the parsing
+ * and formatting of numbers, and the ranges numbers fit at their bounds
+ *
+ */
+#include "Check.hpp"
+
+#include <DataValue.hpp>
+#include <KeyTable.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace serial{
+namespace test{
+
+  namespace{
+
+    /// \brief Builds an array of the integers \p values
+    DataValue make_array( std::initializer_list<std::int32_t> values )
+    {
+      DataValue result(DataValue::type_array);
+      for(auto x : values) result.add_member(DataValue(x));
+      return result;
+    }
+
+    /// \brief Parses \p str with \c set_number
+    DataValue parse_number( std::string_view str )
+    {
+      DataValue result;
+      result.set_number(str);
+      return result;
+    }
+
+    /// \brief Formats \p value with \c to_chars
+    std::string format_number( const DataValue& value )
+    {
+      char buffer[DataValue::max_number_chars];
+      char* last = value.to_chars(buffer, buffer + sizeof(buffer));
+      return last ? std::string(buffer, static_cast<std::size_t>(last - buffer)) : std::string();
+    }
+
+  } // anonymous namespace
+
+  void splice()
+  {
+    DataValue array = make_array({0, 1, 2, 3, 4, 5});
+    const DataValue* moved = &array.at(1);
+
+    // Forward within the array: the index is of the array without the element
+    SERIAL_CHECK(array.splice(4, array, 1));
+    SERIAL_CHECK(array.equals(make_array({0, 2, 3, 4, 1, 5})));
+    SERIAL_CHECK(&array.at(4) == moved);
+
+    // Backward, and onto either end
+    SERIAL_CHECK(array.splice(0, array, 5));
+    SERIAL_CHECK(array.equals(make_array({5, 0, 2, 3, 4, 1})));
+    SERIAL_CHECK(array.splice(5, array, 0));
+    SERIAL_CHECK(array.equals(make_array({0, 2, 3, 4, 1, 5})));
+
+    // Out of range, leaving the array unchanged
+    SERIAL_CHECK(!array.splice(6, array, 0));
+    SERIAL_CHECK(!array.splice(0, array, 6));
+    SERIAL_CHECK(!array.erase(6));
+    SERIAL_CHECK(array.take_member(DataValue::size_type(6)).is_null());
+    SERIAL_CHECK(array.equals(make_array({0, 2, 3, 4, 1, 5})));
+
+    DataValue empty(DataValue::type_array);
+    SERIAL_CHECK(!empty.splice(0, empty, 0));
+
+    // Between parents, and all elements at once
+    DataValue other = make_array({7, 8});
+    SERIAL_CHECK(other.splice(1, array, 0));
+    SERIAL_CHECK(other.equals(make_array({7, 0, 8})));
+    SERIAL_CHECK(array.splice(array.size(), other));
+    SERIAL_CHECK(array.equals(make_array({2, 3, 4, 1, 5, 7, 0, 8})) && other.size() == 0);
+    SERIAL_CHECK(!array.splice(0, array));
+
+    SERIAL_CHECK(array.erase(0));
+    SERIAL_CHECK(array.take_member(DataValue::size_type(0)).as_int() == 3);
+    SERIAL_CHECK(array.equals(make_array({4, 1, 5, 7, 0, 8})));
+
+    // A value cannot be moved into itself
+    DataValue nested(DataValue::type_array);
+    nested.add_member(make_array({1}));
+    DataValue& child = nested.at(0);
+    SERIAL_CHECK(!child.splice(0, nested, 0));
+    SERIAL_CHECK(nested.size() == 1 && child.size() == 1);
+
+    // Objects
+    DataValue object(DataValue::type_object);
+    object.add_member(std::string("splice.a"), DataValue(1));
+    object.add_member(std::string("splice.b"), DataValue(2));
+
+    SERIAL_CHECK(object.splice(std::string("splice.c"), object, std::string("splice.a")));
+    SERIAL_CHECK(!object.has_member(std::string("splice.a")));
+    SERIAL_CHECK(object.at(std::string("splice.c")).as_int() == 1);
+
+    SERIAL_CHECK(object.take_member(std::string("splice.b")).as_int() == 2);
+    SERIAL_CHECK(object.take_member(std::string("splice.b")).is_null());
+    SERIAL_CHECK(!object.remove_member(std::string("splice.b")));
+    SERIAL_CHECK(object.remove_member(std::string("splice.c")));
+    SERIAL_CHECK(object.size() == 0);
+
+    // A splice that fails must not intern the name it would have added
+    DataValue source(DataValue::type_object);
+    source.add_member(std::string("splice.a"), DataValue(1));
+    SERIAL_CHECK(!object.splice(std::string("splice.never_interned"), source, std::string("splice.missing")));
+    SERIAL_CHECK(!object.splice(std::string("splice.never_interned"), array, std::string("splice.a")));
+    SERIAL_CHECK(!KeyTable::find("splice.never_interned").valid());
+    SERIAL_CHECK(source.size() == 1 && object.size() == 0);
+  }
+
+  void number_conversion()
+  {
+    // Integers take the narrowest of int, int64 and uint64
+    const std::int64_t  int64_min  = std::numeric_limits<std::int64_t>::min();
+    const std::uint64_t uint64_max = std::numeric_limits<std::uint64_t>::max();
+
+    DataValue value = parse_number("-9223372036854775808");
+    SERIAL_CHECK(value.type() == DataValue::type_int64 && value.as_int64() == int64_min);
+    value = parse_number("18446744073709551615");
+    SERIAL_CHECK(value.type() == DataValue::type_uint64 && value.as_uint64() == uint64_max);
+    value = parse_number("-2147483648");
+    SERIAL_CHECK(value.type() == DataValue::type_int && value.as_int() == std::numeric_limits<std::int32_t>::min());
+    value = parse_number("2147483648");
+    SERIAL_CHECK(value.type() == DataValue::type_int64 && value.as_int64() == 2147483648LL);
+
+    // Integers beyond the precision of a double stay exact
+    value = parse_number("9007199254740993");
+    SERIAL_CHECK(value.as_int64() == 9007199254740993LL);
+    SERIAL_CHECK(format_number(value) == "9007199254740993");
+
+    // Past uint64 only a double is left
+    value = parse_number("18446744073709551616");
+    SERIAL_CHECK(value.type() == DataValue::type_double && value.as_double() == 18446744073709551616.0);
+
+    // Neither non-finite spellings, nor garbage around a number, parse;
+    // a failed parse leaves the value unchanged
+    for(const char* x : {"inf", "-inf", "infinity", "nan", "NAN", "1e400", "-1e400",
+                         "", "-", ".", "e5", "1e", " 1", "1 ", "1x", "+1", "0x10", "1..2", "1,5"}){
+      DataValue unchanged(std::int32_t(3));
+      SERIAL_CHECK(!unchanged.set_number(x));
+      SERIAL_CHECK(unchanged.type() == DataValue::type_int && unchanged.as_int() == 3);
+    }
+
+    // to_chars writes what set_number reads back as the same value
+    for(const DataValue& x : {DataValue(std::int32_t(0)), DataValue(std::int32_t(-7)),
+                              DataValue(std::numeric_limits<std::int32_t>::max()),
+                              DataValue(std::numeric_limits<std::uint32_t>::max()),
+                              DataValue(int64_min), DataValue(std::numeric_limits<std::int64_t>::max()),
+                              DataValue(uint64_max)}){
+      const DataValue parsed = parse_number(format_number(x));
+      SERIAL_CHECK(parsed.is_integral() && parsed.as_int64() == x.as_int64() && parsed.as_uint64() == x.as_uint64());
+    }
+    for(double x : {0.1, -2.5, 1e-300, 5e-324, 1.7976931348623157e308, 0.30000000000000004, 123456789.125}){
+      const DataValue parsed = parse_number(format_number(DataValue(x)));
+      SERIAL_CHECK(parsed.type() == DataValue::type_double && parsed.as_double() == x);
+    }
+
+    // Strings convert once, only to types the number fits
+    DataValue text;
+    std::int32_t  i   = -1;
+    std::uint32_t u   = 1;
+    std::int64_t  i64 = -1;
+    double        d   = -1;
+    text.set_string("4294967296");
+    SERIAL_CHECK(!text.try_as_int(i) && i == -1);
+    SERIAL_CHECK(!text.try_as_uint(u) && u == 1);
+    SERIAL_CHECK(text.try_as_int64(i64) && i64 == 4294967296LL);
+    text.set_string("-1");
+    SERIAL_CHECK(!text.try_as_uint(u) && u == 1);
+    SERIAL_CHECK(text.try_as_int(i) && i == -1);
+    text.set_string("2.75");
+    SERIAL_CHECK(text.try_as_int(i) && i == 2);
+    SERIAL_CHECK(text.try_as_double(d) && d == 2.75);
+    text.set_string("nan");
+    SERIAL_CHECK(!text.try_as_double(d) && d == 2.75);
+    SERIAL_CHECK(!DataValue(true).try_as_int(i) && i == 2);
+  }
+
+  void range_flags()
+  {
+    using limits_int    = std::numeric_limits<std::int32_t>;
+    using limits_uint   = std::numeric_limits<std::uint32_t>;
+    using limits_int64  = std::numeric_limits<std::int64_t>;
+    using limits_uint64 = std::numeric_limits<std::uint64_t>;
+
+    const std::uint8_t all      = DataValue::fits_integral | DataValue::fits_double;
+    const std::uint8_t signed64 = DataValue::fits_int64 | DataValue::fits_double;
+
+    // Signed integers; negative numbers fit no unsigned type
+    SERIAL_CHECK(DataValue(std::int32_t(0)).ranges() == all);
+    SERIAL_CHECK(DataValue(std::int32_t(-1)).ranges() == (signed64 | DataValue::fits_int));
+    SERIAL_CHECK(!DataValue(std::int32_t(-1)).is_uint() && !DataValue(std::int32_t(-1)).is_uint64());
+    SERIAL_CHECK(DataValue(limits_int::min()).ranges() == (signed64 | DataValue::fits_int));
+    SERIAL_CHECK(DataValue(std::int64_t(limits_int::min()) - 1).ranges() == signed64);
+    SERIAL_CHECK(DataValue(limits_int::max()).ranges() == all);
+    SERIAL_CHECK(DataValue(std::int64_t(limits_int::max()) + 1).ranges() == (all & ~DataValue::fits_int));
+    SERIAL_CHECK(DataValue(std::int64_t(limits_uint::max())).ranges() == (all & ~DataValue::fits_int));
+    SERIAL_CHECK(DataValue(std::int64_t(limits_uint::max()) + 1).ranges() == (signed64 | DataValue::fits_uint64));
+    SERIAL_CHECK(DataValue(limits_int64::min()).ranges() == signed64);
+    SERIAL_CHECK(DataValue(limits_int64::max()).ranges() == (signed64 | DataValue::fits_uint64));
+
+    // Unsigned integers
+    SERIAL_CHECK(DataValue(std::uint32_t(0)).ranges() == all);
+    SERIAL_CHECK(DataValue(std::uint32_t(limits_int::max()) + 1).ranges() == (all & ~DataValue::fits_int));
+    SERIAL_CHECK(DataValue(limits_uint::max()).ranges() == (all & ~DataValue::fits_int));
+    SERIAL_CHECK(DataValue(std::uint64_t(limits_uint::max()) + 1).ranges() == (signed64 | DataValue::fits_uint64));
+    SERIAL_CHECK(DataValue(std::uint64_t(limits_int64::max())).ranges() == (signed64 | DataValue::fits_uint64));
+    SERIAL_CHECK(DataValue(std::uint64_t(limits_int64::max()) + 1).ranges() == (DataValue::fits_uint64 | DataValue::fits_double));
+    SERIAL_CHECK(DataValue(limits_uint64::max()).ranges() == (DataValue::fits_uint64 | DataValue::fits_double));
+
+    // Doubles fit an integer type when they are in range once truncated
+    const double two_63 = 9223372036854775808.0;
+    const double two_64 = 18446744073709551616.0;
+    SERIAL_CHECK(DataValue(0.0).ranges() == all);
+    SERIAL_CHECK(DataValue(-0.0).ranges() == all);
+    SERIAL_CHECK(DataValue(-1.0).ranges() == (signed64 | DataValue::fits_int));
+    SERIAL_CHECK(DataValue(double(limits_int::min())).ranges() == (signed64 | DataValue::fits_int));
+    SERIAL_CHECK(DataValue(double(limits_int::min()) - 1.0).ranges() == signed64);
+    SERIAL_CHECK(DataValue(double(limits_int::max()) + 1.0).ranges() == (all & ~DataValue::fits_int));
+    SERIAL_CHECK(DataValue(double(limits_uint::max())).ranges() == (all & ~DataValue::fits_int));
+    SERIAL_CHECK(DataValue(double(limits_uint::max()) + 1.0).ranges() == (signed64 | DataValue::fits_uint64));
+    SERIAL_CHECK(DataValue(-two_63).ranges() == signed64);
+    SERIAL_CHECK(DataValue(std::nextafter(-two_63, -two_64)).ranges() == DataValue::fits_double);
+    SERIAL_CHECK(DataValue(two_63).ranges() == (DataValue::fits_uint64 | DataValue::fits_double));
+    SERIAL_CHECK(DataValue(std::nextafter(two_64, 0.0)).ranges() == (DataValue::fits_uint64 | DataValue::fits_double));
+    SERIAL_CHECK(DataValue(two_64).ranges() == DataValue::fits_double);
+    SERIAL_CHECK(DataValue(std::numeric_limits<double>::infinity()).ranges() == DataValue::fits_double);
+    SERIAL_CHECK(DataValue(-std::numeric_limits<double>::infinity()).ranges() == DataValue::fits_double);
+    SERIAL_CHECK(DataValue(std::numeric_limits<double>::quiet_NaN()).ranges() == DataValue::fits_double);
+    SERIAL_CHECK(!DataValue(std::numeric_limits<double>::quiet_NaN()).is_integral());
+
+    // Setters recompute the ranges, and non-numbers fit nothing
+    DataValue value(std::int32_t(-1));
+    value.set_uint64(limits_uint64::max());
+    SERIAL_CHECK(value.is_uint64() && !value.is_int64() && !value.is_int());
+    value.set_int64(limits_int64::min());
+    SERIAL_CHECK(value.is_int64() && !value.is_uint64() && !value.is_uint());
+    value.set_double(std::numeric_limits<double>::quiet_NaN());
+    SERIAL_CHECK(value.is_double() && !value.is_integral());
+    value.set_string("1");
+    SERIAL_CHECK(value.ranges() == 0);
+    SERIAL_CHECK(DataValue(true).ranges() == 0);
+    SERIAL_CHECK(DataValue().ranges() == 0);
+    SERIAL_CHECK(DataValue(DataValue::type_array).ranges() == 0);
+  }
+
+} // namespace test
+} // namespace serial
@@ -0,0 +1,135 @@
+/**
+ * \file FixedLayoutTest.cpp
+ *
+ * Checks that truncated and corrupted messages read as absent fields,
+ * never past the end of the buffer
+ *
+ */
+#include "Check.hpp"
+
+#include <DataTranslator.hpp>
+#include <FixedLayout.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace serial{
+namespace test{
+
+  namespace{
+
+    /// \brief A message whose arrays point into its own storage
+    struct message
+    {
+      message() = default;
+      message( const message& ) = delete;
+      message& operator=( const message& ) = delete;
+
+      int          id = 0;
+      std::string  name;
+      int          value_storage[4] = {0, 0, 0, 0};
+      std::string  tag_storage[2];
+      int*         values = value_storage;
+      std::string* tags   = tag_storage;
+    };
+
+    /// \brief Reads every field of \p view, checking that no length exceeds
+    ///        the \p size bytes of the buffer
+    void read_all( const FixedView& view, std::size_t size )
+    {
+      for(std::size_t id = 0; id < view.fields() + 2; ++id){
+        view.get_bool(id);
+        view.get_int(id);
+        view.get_float(id);
+        SERIAL_CHECK(view.get_string(id).size() <= size);
+
+        const std::size_t length = view.get_size(id);
+        SERIAL_CHECK(length <= size);
+        if(length > size) continue;
+
+        for(std::size_t i = 0; i < length; ++i){
+          view.get_bool_at(id, i);
+          view.get_int_at(id, i);
+          view.get_float_at(id, i);
+          SERIAL_CHECK(view.get_string_at(id, i).size() <= size);
+        }
+      }
+    }
+
+  } // anonymous namespace
+
+  void fixed_view()
+  {
+    DataTranslator<message> translator;
+    translator.add_member("id",     &message::id)
+              .add_member("name",   &message::name)
+              .add_member("values", &message::values, 4)
+              .add_member("tags",   &message::tags, 2);
+
+    message input;
+    input.id   = 7;
+    input.name = "fixed";
+    for(int i = 0; i < 4; ++i) input.values[i] = i + 1;
+    input.tags[0] = "a";
+    input.tags[1] = "bc";
+
+    const std::vector<char> bytes = translator.encode(input);
+    SERIAL_CHECK(!bytes.empty());
+
+    message output;
+    SERIAL_CHECK(translator.decode(output, FixedView(bytes.data(), bytes.size())) == 4);
+    SERIAL_CHECK(output.id == 7 && output.name == "fixed" && output.values[3] == 4 && output.tags[1] == "bc");
+
+    const std::size_t values = translator.layout().field_id("values");
+    const std::size_t tags   = translator.layout().field_id("tags");
+
+    // Truncated buffers are invalid; truncated messages whose header
+    // claims the shorter size read only what is left
+    for(std::size_t size = 0; size < bytes.size(); ++size){
+      std::vector<char> truncated(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(size));
+      SERIAL_CHECK(!FixedView(truncated.data(), truncated.size()).valid());
+
+      if(size >= sizeof(std::uint32_t)){
+        const std::uint32_t claimed = static_cast<std::uint32_t>(size);
+        std::memcpy(truncated.data(), &claimed, sizeof(claimed));
+      }
+      const FixedView view(truncated.data(), truncated.size());
+      read_all(view, size);
+
+      message partial;
+      translator.decode(partial, view);
+    }
+
+    // A hostile length reads as an absent array
+    std::vector<char> corrupted = bytes;
+    std::uint16_t slot;
+    std::memcpy(&slot, corrupted.data() + 8 + 2 * values, sizeof(slot));
+    const std::uint32_t huge = 0xffffffff;
+    std::memcpy(corrupted.data() + slot + sizeof(std::uint32_t), &huge, sizeof(huge));
+    {
+      const FixedView view(corrupted.data(), corrupted.size());
+      SERIAL_CHECK(view.get_size(values) == 0);
+      SERIAL_CHECK(view.get_int_at(values, 0) == 0);
+      SERIAL_CHECK(view.get_size(tags) == 2 && view.get_string_at(tags, 1) == "bc");
+    }
+
+    // Random corruption never reads out of bounds
+    std::mt19937 random(44);
+    for(int i = 0; i < 2000; ++i){
+      corrupted = bytes;
+      for(int n = 0; n < 4; ++n){
+        corrupted[random() % corrupted.size()] = static_cast<char>(random());
+      }
+      const FixedView view(corrupted.data(), corrupted.size());
+      read_all(view, corrupted.size());
+
+      message decoded;
+      translator.decode(decoded, view);
+    }
+  }
+
+} // namespace test
+} // namespace serial
@@ -0,0 +1,102 @@
+/**
+ * \file KeyTableTest.cpp
+ *
+ * Checks that keys interned and found concurrently resolve to one handle,
+ * that object keys are ordered by name, and that untrusted names cannot
+ * grow a full table
+ *
+ */
+#include "Check.hpp"
+
+#include <DataPatch.hpp>
+#include <DataValue.hpp>
+#include <KeyTable.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace serial{
+namespace test{
+
+  void key_table()
+  {
+    // Every thread races to intern and find the same keys
+    const std::size_t keys = 5000;
+    std::vector<std::vector<key_handle>> handles(4, std::vector<key_handle>(keys));
+    std::vector<std::thread> threads;
+    for(std::size_t t = 0; t < handles.size(); ++t){
+      threads.emplace_back([&handles, keys, t]{
+        for(std::size_t i = 0; i < 4 * keys; ++i){
+          const std::size_t k = (i * 7 + t) % keys;
+          const std::string name = "key_table." + std::to_string(k);
+
+          const key_handle found = KeyTable::find(name);
+          if(found.valid()) SERIAL_CHECK(found.name() == name);
+
+          const key_handle interned = KeyTable::intern(name);
+          SERIAL_CHECK(interned.valid() && interned.name() == name);
+          SERIAL_CHECK(KeyTable::find(name) == interned);
+          handles[t][k] = interned;
+        }
+      });
+    }
+    for(auto& x : threads) x.join();
+
+    for(std::size_t k = 0; k < keys; ++k){
+      for(std::size_t t = 1; t < handles.size(); ++t){
+        SERIAL_CHECK(handles[t][k] == handles[0][k]);
+      }
+    }
+
+    // Keys are ordered by name, not by the order they were interned in
+    KeyTable::intern("key_table.zeta");
+    KeyTable::intern("key_table.alpha_long_name_1");
+    KeyTable::intern("key_table.alpha_long_name_0");
+
+    DataValue object(DataValue::type_object);
+    object.add_member(std::string("key_table.zeta"), DataValue(1));
+    object.add_member(std::string("key_table.alpha_long_name_1"), DataValue(2));
+    object.add_member(std::string("key_table.alpha_long_name_0"), DataValue(3));
+
+    std::string previous;
+    for(auto x : object.members()){
+      SERIAL_CHECK(previous < x.key.name());
+      previous = x.key.name();
+    }
+
+    // Once full, the table admits no new keys through try_intern
+    const std::size_t limit = KeyTable::limit();
+    KeyTable::set_limit(KeyTable::bytes());
+    SERIAL_CHECK(!KeyTable::try_intern("key_table.never_admitted").valid());
+    SERIAL_CHECK(KeyTable::try_intern("key_table.zeta").valid());
+
+    // Neither do patches, nor splices by name
+    const auto add = []( const std::string& path ){
+      DataValue operation(DataValue::type_object);
+      DataValue op, value;
+      op.set_string("add");
+      value.set_string(path);
+      operation.add_member(std::string("op"), op);
+      operation.add_member(std::string("path"), value);
+      operation.add_member(std::string("value"), DataValue(1));
+
+      DataValue patch(DataValue::type_array);
+      patch.add_member(std::move(operation));
+      return patch;
+    };
+    DataValue target(DataValue::type_object);
+    SERIAL_CHECK(!apply_patch(target, add("/key_table.never_admitted")));
+    SERIAL_CHECK(target.size() == 0);
+    SERIAL_CHECK(apply_patch(target, add("/key_table.zeta")));
+    SERIAL_CHECK(target.size() == 1);
+
+    SERIAL_CHECK(!object.splice(std::string("key_table.never_admitted"), target, std::string("key_table.zeta")));
+    SERIAL_CHECK(target.size() == 1);
+    SERIAL_CHECK(!KeyTable::find("key_table.never_admitted").valid());
+
+    KeyTable::set_limit(limit);
+  }
+
+} // namespace test
+} // namespace serial
@@ -0,0 +1,85 @@
+/**
+ * \file SharedDocumentTest.cpp
+ *
+ * Checks that readers of a document being republished always see a whole
+ * version, and that copies of a shared tree detach before they are written
+ *
+ */
+#include "Check.hpp"
+
+#include <SharedDocument.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace serial{
+namespace test{
+
+  namespace{
+
+    /// \brief Builds version \p version of the document, whose items all
+    ///        hold the version
+    DataValue make_version( std::int32_t version )
+    {
+      DataValue items(DataValue::type_array);
+      for(int i = 0; i < 32; ++i) items.add_member(DataValue(version));
+
+      DataValue result(DataValue::type_object);
+      result.add_member(std::string("version"), DataValue(version));
+      result.add_member(std::string("items"), std::move(items));
+      return result;
+    }
+
+  } // anonymous namespace
+
+  void shared_document()
+  {
+    const std::int32_t versions = 2000;
+
+    SharedDocument document(make_version(0));
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> readers;
+    for(int t = 0; t < 3; ++t){
+      readers.emplace_back([&]{
+        std::int32_t previous = 0;
+        while(!done){
+          DataValue copy;
+          {
+            const SharedDocument::snapshot current = document.read();
+            const std::int32_t version = current->at(std::string("version")).as_int();
+            SERIAL_CHECK(version >= previous);
+            previous = version;
+
+            bool whole = true;
+            for(const auto& x : current->at(std::string("items")).elements()){
+              whole = whole && x.as_int() == version;
+            }
+            SERIAL_CHECK(whole);
+            copy = *current;
+          }
+
+          // Writing to the copy must leave the shared tree untouched
+          copy.at(std::string("items")).add_member(DataValue(-1));
+          SERIAL_CHECK(copy.at(std::string("items")).size() == 33);
+        }
+      });
+    }
+
+    for(std::int32_t v = 1; v <= versions; ++v){
+      document.publish(make_version(v));
+    }
+    done = true;
+    for(auto& x : readers) x.join();
+
+    SERIAL_CHECK(document.reclaim() == 0);
+    const SharedDocument::snapshot last = document.read();
+    SERIAL_CHECK(last->at(std::string("version")).as_int() == versions);
+    SERIAL_CHECK(last->at(std::string("items")).size() == 32);
+  }
+
+} // namespace test
+} // namespace serial
@@ -0,0 +1,60 @@
+/**
+ * \file ThreadPoolTest.cpp
+ *
+ * Checks that parallel_for covers its range exactly once, nests, and
+ * rethrows an exception thrown by any task
+ *
+ */
+#include "Check.hpp"
+
+#include <ThreadPool.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace serial{
+namespace test{
+
+  void thread_pool()
+  {
+    for(std::size_t threads : {1, 2, 4}){
+      ThreadPool pool(threads);
+
+      std::vector<std::atomic<int>> visits(100000);
+      for(auto& x : visits) x = 0;
+      pool.parallel_for(0, visits.size(), 64, [&]( std::size_t first, std::size_t last ){
+        for(std::size_t i = first; i < last; ++i) ++visits[i];
+      });
+      bool once = true;
+      for(const auto& x : visits) once = once && x == 1;
+      SERIAL_CHECK(once);
+
+      // A throwing task fails the whole loop, which rethrows on the caller
+      for(int round = 0; round < 20; ++round){
+        bool caught = false;
+        try{
+          pool.parallel_for(0, 10000, 16, []( std::size_t first, std::size_t last ){
+            if(first <= 5000 && 5000 < last) throw std::runtime_error("task");
+          });
+        }catch(const std::runtime_error&){
+          caught = true;
+        }
+        SERIAL_CHECK(caught);
+      }
+
+      // The pool stays usable after a failed loop, including from its tasks
+      std::atomic<std::size_t> nested(0);
+      pool.parallel_for(0, 64, 1, [&]( std::size_t first, std::size_t last ){
+        for(std::size_t i = first; i < last; ++i){
+          pool.parallel_for(0, 1000, 10, [&]( std::size_t a, std::size_t b ){
+            nested += b - a;
+          });
+        }
+      });
+      SERIAL_CHECK(nested == 64000);
+    }
+  }
+
+} // namespace test
+} // namespace serial
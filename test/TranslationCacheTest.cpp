@@ -0,0 +1,132 @@
+/**
+ * \file TranslationCacheTest.cpp
+ *
+ * Checks that cached translations assign only the members their input
+ * sets, that inputs whose hashes collide are told apart, and that the
+ * least recently used translation is evicted
+ *
+ */
+#include "Check.hpp"
+
+#include <TranslationCache.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace serial{
+namespace test{
+
+  namespace{
+
+    struct record
+    {
+      std::int32_t id    = -1;
+      float        score = -1;
+      std::string  name  = "unset";
+      double       ratio = -1;
+    };
+
+    /// \brief Hashes every input to the same value
+    struct colliding_hash
+    {
+      std::size_t operator()( std::string_view ) const noexcept { return 0; }
+    };
+
+    /// \brief Parses "<id>" into an object with only the member "id", or
+    ///        "<id>,<ratio>" into one that also has the converted "ratio"
+    struct parser
+    {
+      DataValue operator()( std::string_view bytes ) const
+      {
+        ++calls;
+
+        DataValue result(DataValue::type_object);
+        const std::size_t comma = bytes.find(',');
+        result.add_member(std::string("id"), DataValue(std::stoi(std::string(bytes.substr(0, comma)))));
+        if(comma != std::string_view::npos){
+          result.add_member(std::string("ratio"), DataValue(std::stod(std::string(bytes.substr(comma + 1)))));
+        }
+        return result;
+      }
+
+      mutable std::size_t calls = 0;
+    };
+
+  } // anonymous namespace
+
+  void translation_cache()
+  {
+    DataTranslator<record> translator;
+    translator.add_member("id",    &record::id)
+              .add_member("score", &record::score)
+              .add_member("name",  &record::name)
+              .add_member("ratio", &record::ratio);
+
+    // Members the input does not set are left unchanged, hit or miss
+    {
+      TranslationCache<record> cache(translator, 4);
+      parser parse;
+      for(int round = 0; round < 2; ++round){
+        record object;
+        object.name = "kept";
+        SERIAL_CHECK(cache.translate(object, "7,0.5", parse) == 2);
+        SERIAL_CHECK(object.id == 7 && object.ratio == 0.5);
+        SERIAL_CHECK(object.score == -1 && object.name == "kept");
+
+        record other;
+        SERIAL_CHECK(cache.translate(other, "8", parse) == 1);
+        SERIAL_CHECK(other.id == 8 && other.ratio == -1 && other.name == "unset");
+      }
+      SERIAL_CHECK(parse.calls == 2);
+      SERIAL_CHECK(cache.hits() == 2 && cache.misses() == 2 && cache.size() == 2);
+    }
+
+    // Inputs with the same hash are confirmed by their bytes
+    {
+      TranslationCache<record,colliding_hash> cache(translator, 4);
+      parser parse;
+      record object;
+      cache.translate(object, "1", parse);
+      SERIAL_CHECK(object.id == 1);
+      cache.translate(object, "2", parse);
+      SERIAL_CHECK(object.id == 2);
+      cache.translate(object, "1", parse);
+      SERIAL_CHECK(object.id == 1);
+      SERIAL_CHECK(parse.calls == 3 && cache.hits() == 0 && cache.misses() == 3);
+      SERIAL_CHECK(cache.size() == 1);
+    }
+
+    // The least recently used translation is evicted first
+    {
+      TranslationCache<record> cache(translator, 2);
+      parser parse;
+      record object;
+      for(const char* x : {"1", "2", "1", "3", "2", "3", "1"}){
+        cache.translate(object, x, parse);
+        SERIAL_CHECK(object.id == std::stoi(x));
+      }
+      // 1 and 2 miss, 1 hits, 3 evicts 2, 2 evicts 1, 3 hits, 1 evicts 2
+      SERIAL_CHECK(cache.hits() == 2 && cache.misses() == 5);
+      SERIAL_CHECK(parse.calls == 5 && cache.size() == 2);
+
+      cache.clear();
+      SERIAL_CHECK(cache.size() == 0);
+      cache.translate(object, "3", parse);
+      SERIAL_CHECK(parse.calls == 6);
+    }
+
+    // Nothing is kept without capacity
+    {
+      TranslationCache<record> cache(translator, 0);
+      parser parse;
+      record object;
+      cache.translate(object, "1", parse);
+      cache.translate(object, "1", parse);
+      SERIAL_CHECK(object.id == 1 && parse.calls == 2 && cache.size() == 0);
+    }
+  }
+
+} // namespace test
+} // namespace serial
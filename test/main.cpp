@@ -0,0 +1,68 @@
+/**
+ * \file main.cpp
+ *
+ * Runs the tests named on the command line, or every test if none is
+ * named, and exits with a failure status if any check failed.
+ *
+ * Usage: serial_test [name...]
+ *
+ */
+#include "Check.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace serial{
+namespace test{
+
+  std::atomic<std::size_t> failures(0);
+
+  void fail( const char* file, int line, const char* expression )
+  {
+    ++failures;
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+  }
+
+} // namespace test
+} // namespace serial
+
+namespace{
+
+  struct test_case
+  {
+    const char* name;
+    void (*run)();
+  };
+
+  const test_case tests[] = {
+    {"shared_document",   &serial::test::shared_document},
+    {"key_table",         &serial::test::key_table},
+    {"schema",            &serial::test::schema},
+    {"thread_pool",       &serial::test::thread_pool},
+    {"array_builder",     &serial::test::array_builder},
+    {"patch_round_trip",  &serial::test::patch_round_trip},
+    {"deep_patch",        &serial::test::deep_patch},
+    {"splice",            &serial::test::splice},
+    {"translation_cache", &serial::test::translation_cache},
+    {"number_conversion", &serial::test::number_conversion},
+    {"range_flags",       &serial::test::range_flags},
+    {"fixed_view",        &serial::test::fixed_view},
+  };
+
+} // anonymous namespace
+
+int main( int argc, char** argv )
+{
+  for(const auto& x : tests){
+    bool selected = argc < 2;
+    for(int i = 1; i < argc && !selected; ++i){
+      selected = std::strcmp(argv[i], x.name) == 0;
+    }
+    if(!selected) continue;
+
+    const std::size_t before = serial::test::failures;
+    x.run();
+    std::printf("%s: %s\n", x.name, serial::test::failures == before ? "passed" : "FAILED");
+  }
+  return serial::test::failures == 0 ? 0 : 1;
+}